@@ -5,6 +5,8 @@ if(BUILD_TESTING)
   add_subdirectory(test)
 endif()
 
+add_subdirectory(harness)
+
 include(cmake/lint-targets.cmake)
 include(cmake/spell-targets.cmake)
 
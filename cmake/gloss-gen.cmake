@@ -0,0 +1,57 @@
+# gloss_generate_table(<target> INPUT <file> NAME <name> [NAMESPACE <ns>]
+#                      [METHOD any|pext|array] [KEY_TYPE auto|int|string]
+#                      [RESULT_TYPE <type>] [INCLUDES <header>...]
+#                      [THREADS <n>] [ALIGN <bytes>] [OUTPUT_VARIABLE <var>])
+#
+# Runs gloss-gen on <file> and adds the resulting <name>.hpp to <target>. The header
+# is only regenerated when the input (or the generator itself) changes, so the
+# perfect hash search happens once instead of in every translation unit.
+function(gloss_generate_table target)
+  cmake_parse_arguments(
+      PARSE_ARGV 1 GEN
+      ""
+      "INPUT;NAME;NAMESPACE;METHOD;KEY_TYPE;RESULT_TYPE;THREADS;ALIGN;OUTPUT_VARIABLE"
+      "INCLUDES"
+  )
+  if(NOT GEN_INPUT OR NOT GEN_NAME)
+    message(FATAL_ERROR "gloss_generate_table: INPUT and NAME are required")
+  endif()
+  if(NOT TARGET gloss::gen)
+    message(
+        FATAL_ERROR
+        "gloss_generate_table: the gloss::gen target is not available, "
+        "configure gloss with gloss_BUILD_GENERATOR=ON"
+    )
+  endif()
+
+  get_filename_component(input "${GEN_INPUT}" ABSOLUTE)
+  set(output_dir "${CMAKE_CURRENT_BINARY_DIR}/gloss_generated")
+  set(output "${output_dir}/${GEN_NAME}.hpp")
+
+  set(args --input "${input}" --output "${output}" --name "${GEN_NAME}")
+  foreach(option IN ITEMS NAMESPACE METHOD KEY_TYPE RESULT_TYPE THREADS ALIGN)
+    if(DEFINED GEN_${option})
+      string(TOLOWER "${option}" flag)
+      string(REPLACE "_" "-" flag "${flag}")
+      list(APPEND args "--${flag}" "${GEN_${option}}")
+    endif()
+  endforeach()
+  foreach(include IN LISTS GEN_INCLUDES)
+    list(APPEND args --include "${include}")
+  endforeach()
+
+  add_custom_command(
+      OUTPUT "${output}"
+      COMMAND "${CMAKE_COMMAND}" -E make_directory "${output_dir}"
+      COMMAND gloss::gen ${args}
+      DEPENDS "${input}" gloss::gen
+      COMMENT "Generating perfect hash table ${GEN_NAME}"
+      VERBATIM
+  )
+  target_sources("${target}" PRIVATE "${output}")
+  target_include_directories("${target}" PRIVATE "${output_dir}")
+
+  if(GEN_OUTPUT_VARIABLE)
+    set("${GEN_OUTPUT_VARIABLE}" "${output}" PARENT_SCOPE)
+  endif()
+endfunction()
@@ -5,4 +5,5 @@ find_dependency(fmt)
 
 if(gloss_FOUND)
   include("${CMAKE_CURRENT_LIST_DIR}/glossTargets.cmake")
+  include("${CMAKE_CURRENT_LIST_DIR}/gloss-gen.cmake")
 endif()
@@ -17,7 +17,7 @@ include(GNUInstallDirs)
 set(package gloss)
 
 install(
-    DIRECTORY include/
+    FILES gloss.hpp
     DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}"
     COMPONENT gloss_Development
 )
@@ -28,6 +28,15 @@ install(
     INCLUDES DESTINATION "${CMAKE_INSTALL_INCLUDEDIR}"
 )
 
+if(TARGET gloss_gen)
+  set_property(TARGET gloss_gen PROPERTY EXPORT_NAME gen)
+  install(
+      TARGETS gloss_gen
+      EXPORT glossTargets
+      RUNTIME COMPONENT gloss_Runtime
+  )
+endif()
+
 write_basic_package_version_file(
     "${package}ConfigVersion.cmake"
     COMPATIBILITY SameMajorVersion
@@ -49,6 +58,12 @@ install(
     COMPONENT gloss_Development
 )
 
+install(
+    FILES cmake/gloss-gen.cmake
+    DESTINATION "${gloss_INSTALL_CMAKEDIR}"
+    COMPONENT gloss_Development
+)
+
 install(
     FILES "${PROJECT_BINARY_DIR}/${package}ConfigVersion.cmake"
     DESTINATION "${gloss_INSTALL_CMAKEDIR}"
@@ -8,6 +8,16 @@ if(PROJECT_IS_TOP_LEVEL)
   option(gloss_DEVELOPER_MODE "Enable developer mode" OFF)
 endif()
 
+# ---- Table generator ----
+
+# gloss-gen runs the perfect hash search offline for tables too large to search at
+# compile time. Consumers that only need the header can turn it off.
+option(
+    gloss_BUILD_GENERATOR
+    "Build the gloss-gen table generator"
+    "${PROJECT_IS_TOP_LEVEL}"
+)
+
 # ---- Warning guard ----
 
 # target_include_directories with the SYSTEM modifier will request the compiler
@@ -10,7 +10,12 @@
 #include <algorithm>
 #include <array>
 #include <bit>
+#include <functional>
 #include <ranges>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace gloss {
 
@@ -141,33 +146,43 @@ get_type()
 #endif
 }
 
-template <const auto& Table>
-struct entries {
-    using pair_type = std::ranges::range_value_t<decltype(Table)>;
-    static constexpr auto SIZE = Table.size();
+struct project_first {
+    constexpr const auto&
+    operator()(const auto& pair) const noexcept
+    {
+        return pair.first;
+    }
+};
+
+// Packs a range of keys (or of whatever Project picks out of each element) into
+// integral words
+template <const auto& Range, typename Project = std::identity>
+struct packed_keys {
+    using raw_type = std::remove_cvref_t<
+        std::invoke_result_t<Project, std::ranges::range_value_t<decltype(Range)>>>;
+    static constexpr auto SIZE = Range.size();
 
     // Support string_view, const char*, and integral keys
     using key_type = decltype([]() {
-        if constexpr (std::is_enum_v<typename pair_type::first_type>) {
-            return std::underlying_type_t<typename pair_type::first_type>{};
+        if constexpr (std::is_enum_v<raw_type>) {
+            return std::underlying_type_t<raw_type>{};
         }
-        else if constexpr (requires { Table[0].first.size(); }) {
+        else if constexpr (requires { Project{}(Range[0]).size(); }) {
             static constexpr auto MAX_SIZE = []() {
                 std::size_t max{};
                 for (std::size_t i = 0; i < SIZE; ++i) {
-                    max = std::max(max, Table[i].first.size());
+                    max = std::max(max, Project{}(Range[i]).size());
                 }
                 return max;
             }();
 
             return get_type<MAX_SIZE>();
         }
-        else if constexpr (std::is_same_v<
-                               typename pair_type::first_type, const char*>) {
+        else if constexpr (std::is_same_v<raw_type, const char*>) {
             static constexpr auto MAX_SIZE = []() {
                 std::size_t max{};
                 for (std::size_t i = 0; i < SIZE; ++i) {
-                    const char* tmp = Table[i].first;
+                    const char* tmp = Project{}(Range[i]);
                     std::size_t len{};
                     while (*tmp != '\0') {
                         ++tmp;
@@ -181,10 +196,26 @@ struct entries {
             return get_type<MAX_SIZE>();
         }
         else {
-            return typename pair_type::first_type{};
+            return raw_type{};
         }
     }());
 
+    static constexpr auto KEYS = []() {
+        std::array<key_type, SIZE> keys;
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            keys[i] = to<key_type>(Project{}(Range[i]));
+        }
+        return keys;
+    }();
+};
+
+template <const auto& Table>
+struct entries {
+    using pair_type = std::ranges::range_value_t<decltype(Table)>;
+    static constexpr auto SIZE = Table.size();
+
+    using key_type = packed_keys<Table, project_first>::key_type;
+
     using mapped_type = decltype([]() {
         if constexpr (std::is_enum_v<typename pair_type::second_type>) {
             return std::underlying_type_t<typename pair_type::second_type>{};
@@ -215,6 +246,80 @@ template <typename R>
 concept PairRange =
     std::ranges::forward_range<R> && Pair<std::ranges::range_value_t<R>>;
 
+// Bits needed for the widest value. Both magic tables slot keys by the bits of
+// key * magic above 32 - this.
+constexpr u32
+value_bits(const auto& mappings)
+{
+    u32 max = 0;
+    for (const auto& pair : mappings) {
+        max = std::max(static_cast<u32>(pair.second), max);
+    }
+    return (sizeof(u32) * __CHAR_BIT__) - static_cast<u32>(std::countl_zero(max));
+}
+
+// Value packed at key's position in a magic LUT of nbits wide values. lookup_magic_lut
+// and its search both read the LUT through this.
+template <typename ValueType>
+constexpr ValueType
+magic_lut_value(ValueType lut, ValueType magic, const auto& key, u32 nbits) noexcept
+{
+    const auto shift = static_cast<ValueType>((sizeof(u32) * __CHAR_BIT__) - nbits);
+    const auto mask = static_cast<ValueType>((1uz << nbits) - 1uz);
+    return static_cast<ValueType>((lut >> ((key * magic) >> shift)) & mask);
+}
+
+template <typename ValueType>
+struct magic_lut_result {
+    ValueType magic{};
+    ValueType lut{};
+    std::uint32_t attempts{};
+};
+
+// Search behind lookup_magic_lut. Works on any range of packed (key, value) pairs so it
+// can also run outside constant evaluation; a zero lut means no magic was found.
+template <typename ValueType>
+constexpr auto
+find_magic_lut(const auto& mappings, std::uint32_t max_attempts = 10'000)
+    -> magic_lut_result<ValueType>
+{
+    const auto nbits = value_bits(mappings);
+    const auto shift = static_cast<ValueType>((sizeof(u32) * __CHAR_BIT__) - nbits);
+
+    magic_lut_result<ValueType> result{};
+    random::pcg rand_pcg{};
+
+    // Values won't fit in the LUT
+    if (nbits * std::ranges::size(mappings) > (sizeof(ValueType) * __CHAR_BIT__))
+        return result;
+
+    auto attempt_find_perfect_hash = [&]() {
+        result.magic = rand_pcg();
+        for (const auto& [key, value] : mappings) {
+            u32 slot = u32((key * result.magic) >> shift);
+            if (slot >= sizeof(ValueType) * __CHAR_BIT__) {
+                result.lut = {};
+                return;
+            }
+
+            result.lut |= ValueType(value) << slot;
+        }
+
+        for (const auto& [key, value] : mappings) {
+            if (magic_lut_value(result.lut, result.magic, key, nbits) != value) {
+                result.lut = {};
+                return;
+            }
+        }
+    };
+
+    while (result.lut == 0 && max_attempts-- > 0) {
+        ++result.attempts;
+        attempt_find_perfect_hash();
+    }
+    return result;
+}
+
 template <const auto& Table, typename ValueType>
 requires PairRange<decltype(Table)>
 struct lookup_magic_lut {
@@ -224,35 +329,10 @@ struct lookup_magic_lut {
 
     consteval explicit lookup_magic_lut(std::uint32_t max_attempts = 10'000) noexcept
     {
-        random::pcg rand_pcg{};
-
-        // Values won't fit in the LUT
-        if (NBITS * Table.size() > (sizeof(ValueType) * __CHAR_BIT__))
-            return;
-
-        auto attempt_find_perfect_hash = [&]() {
-            magic_ = rand_pcg();
-            for (const auto& [key, value] : entries<Table>::MAPPINGS) {
-                u32 shift = u32((key * magic_) >> SHIFT);
-                if (shift >= sizeof(ValueType) * __CHAR_BIT__) {
-                    lut_ = {};
-                    return;
-                }
-
-                lut_ |= ValueType(value) << shift;
-            }
-
-            for (const auto& [key, value] : entries<Table>::MAPPINGS) {
-                if ((lut_ >> (ValueType(key) * magic_ >> SHIFT) & MASK) != value) {
-                    lut_ = {};
-                    return;
-                }
-            }
-        };
-
-        while (lut_ == 0 && max_attempts-- > 0) {
-            attempt_find_perfect_hash();
-        }
+        const auto result =
+            find_magic_lut<ValueType>(entries<Table>::MAPPINGS, max_attempts);
+        magic_ = result.magic;
+        lut_ = result.lut;
     }
 
     constexpr explicit
@@ -265,20 +345,12 @@ struct lookup_magic_lut {
     operator()(const auto& search_key) const noexcept
     {
         return to<result_type>(
-            (lut_ >> ((to<key_type>(search_key) * magic_) >> SHIFT)) & MASK
+            magic_lut_value(lut_, magic_, to<key_type>(search_key), NBITS)
         );
     }
 
 private:
-    static constexpr ValueType MAX_BITS = []() {
-        u32 max = 0;
-        for (const auto& pair : entries<Table>::MAPPINGS) {
-            max = std::max(static_cast<u32>(pair.second), max);
-        }
-        // std::countl_zero counts differently, so use builtin
-        return std::countl_zero(max);
-    }();
-    static constexpr ValueType NBITS = (sizeof(u32) * __CHAR_BIT__) - MAX_BITS;
+    static constexpr u32 NBITS = value_bits(entries<Table>::MAPPINGS);
     static constexpr ValueType MASK = (1uz << NBITS) - 1uz;
     static constexpr ValueType SHIFT = (sizeof(u32) * __CHAR_BIT__) - NBITS;
 
@@ -295,7 +367,7 @@ pext(const T& value, T mask)
         auto dst_pos = 0u;
         for (std::size_t i = 0; i < Size; ++i) {
             if (mask & 1)
-                tmp |= ((value >> i) & 1) << dst_pos++;
+                tmp |= static_cast<T>(((value >> i) & 1) << dst_pos++);
             mask >>= 1;
         }
         return tmp;
@@ -306,56 +378,91 @@ pext(const T& value, T mask)
     }
 #ifdef __BMI2__
     if constexpr (requires { u32{mask}; }) {
-        return __builtin_ia32_pext_si(value, mask);
+        return static_cast<T>(__builtin_ia32_pext_si(value, mask));
     }
     if constexpr (requires { u64{mask}; }) {
         return static_cast<T>(__builtin_ia32_pext_di(value, mask));
     }
+#  if defined(__SIZEOF_INT128__)
+    if constexpr (sizeof(T) == sizeof(u128)) {
+        // Extract each half, then pack the high half above the low half's bits
+        const auto low_mask = static_cast<u64>(mask);
+        const auto low = __builtin_ia32_pext_di(static_cast<u64>(value), low_mask);
+        const auto high = __builtin_ia32_pext_di(
+            static_cast<u64>(value >> 64), static_cast<u64>(mask >> 64)
+        );
+        return static_cast<T>(T(high) << std::popcount(low_mask)) | T(low);
+    }
+#  endif
 
 #endif
     return manual_pext();
 }
 
-template <const auto& Table>
-consteval auto
-find_mask() -> entries<Table>::key_type
+// Greedily drops key bits, high to low, while the keys stay distinct under the mask.
+// Distinctness is checked by sorting rather than comparing every pair, so the same
+// search serves gloss-gen's large key sets.
+constexpr auto
+find_unique_mask(const std::ranges::random_access_range auto& keys)
 {
-    using key_type = entries<Table>::key_type;
-    static constexpr auto MAPPINGS = entries<Table>::MAPPINGS;
-
-    constexpr std::size_t SIZE = Table.size();
-    constexpr int NUM_BITS = sizeof(key_type) * __CHAR_BIT__;
-    key_type cur_mask = std::numeric_limits<key_type>::max();
+    using Key = std::ranges::range_value_t<decltype(keys)>;
+    constexpr int NUM_BITS = sizeof(Key) * __CHAR_BIT__;
+    Key cur_mask = std::numeric_limits<Key>::max();
+    std::vector<Key> masked(std::ranges::size(keys));
 
     for (int bit = NUM_BITS - 1; bit >= 0; --bit) {
-        key_type test_mask = cur_mask & static_cast<key_type>(~(key_type(1) << bit));
+        Key test_mask = cur_mask & static_cast<Key>(~(Key(1) << bit));
 
-        bool unique = true;
-        for (std::size_t i = 0; i < SIZE && unique; ++i) {
-            for (std::size_t j = i + 1; j < SIZE; ++j) {
-                if (((MAPPINGS[i].first & test_mask) == (MAPPINGS[j].first & test_mask)
-                    )) {
-                    unique = false;
-                    break;
-                }
-            }
-        }
-        if (unique) {
+        std::ranges::transform(keys, masked.begin(), [&](const Key& key) {
+            return static_cast<Key>(key & test_mask);
+        });
+        std::ranges::sort(masked);
+        if (std::ranges::adjacent_find(masked) == masked.end()) {
             cur_mask = test_mask;
         }
     }
     return cur_mask;
 }
 
+// pext runs on the narrowest of 32, 64 or 128 bits that holds the mask
+constexpr std::size_t
+pext_word_bytes(const auto& mask) noexcept
+{
+    if (mask <= std::numeric_limits<u32>::max()) {
+        return sizeof(u32);
+    }
+    if (mask <= std::numeric_limits<u64>::max()) {
+        return sizeof(u64);
+    }
+    return sizeof(mask);
+}
+
 template <const auto& Table>
+consteval auto
+find_mask() -> entries<Table>::key_type
+{
+    return find_unique_mask(packed_keys<Table, project_first>::KEYS);
+}
+
+// Alignment of a slot array: Align when given, e.g. 64 to start the slots on a cache
+// line, and never less than the array itself needs
+template <typename Slots, std::size_t Align>
+inline constexpr std::size_t SLOT_ALIGNMENT = std::max(Align, alignof(Slots));
+
+// Slots of a precomputed table: a fixed array as gloss-gen emits it, or with
+// std::dynamic_extent a vector, for tables built at runtime such as the harness's.
+// alignas would only reach the vector's handle, not its heap buffer, so a vector
+// can't take an Align.
+template <typename T, std::size_t Size>
+using slot_array = std::conditional_t<
+    Size == std::dynamic_extent, std::vector<T>, std::array<T, Size>>;
+
+template <const auto& Table, std::size_t Align = 0>
 requires PairRange<decltype(Table)>
 struct lookup_pext {
     using key_type = entries<Table>::key_type;
     static constexpr key_type MASK = find_mask<Table>();
-    using value_type_wide =
-        std::conditional_t<MASK <= std::numeric_limits<u64>::max(), u64, key_type>;
-    using value_type = std::conditional_t<
-        MASK <= std::numeric_limits<u32>::max(), u32, value_type_wide>;
+    using value_type = decltype(get_type<pext_word_bytes(MASK)>());
     static constexpr value_type MASK_NARROW = static_cast<value_type>(MASK);
 
     using mapped_type = entries<Table>::mapped_type;
@@ -364,10 +471,25 @@ struct lookup_pext {
     constexpr result_type
     operator()(const auto& search_key) const noexcept
     {
-        return static_cast<result_type>(
-            TABLE[static_cast<std::size_t>(pext(to<value_type>(search_key), MASK_NARROW)
-            )]
-        );
+        return value_at(slot(search_key));
+    }
+
+    constexpr result_type
+    value_at(std::size_t slot) const noexcept
+    {
+        return static_cast<result_type>(TABLE[slot]);
+    }
+
+    constexpr std::size_t
+    slot(const auto& search_key) const noexcept
+    {
+        return static_cast<std::size_t>(pext(to<value_type>(search_key), MASK_NARROW));
+    }
+
+    constexpr const auto&
+    slots() const noexcept
+    {
+        return TABLE;
     }
 
 private:
@@ -379,6 +501,7 @@ private:
         return max + 1u;
     }();
 
+    alignas(SLOT_ALIGNMENT<std::array<mapped_type, SIZE>, Align>)
     static constexpr std::array<mapped_type, SIZE> TABLE = []() {
         std::array<mapped_type, SIZE> table{};
         for (const auto& [key, value] : entries<Table>::MAPPINGS) {
@@ -389,7 +512,65 @@ private:
     }();
 };
 
-template <const auto& Table>
+// Slot of key in a magic array of size slots holding nbits wide values.
+// lookup_magic_array and its search both slot keys through this.
+constexpr std::size_t
+magic_array_slot(const auto& key, u64 magic, u32 nbits, std::size_t size) noexcept
+{
+    const u64 shift = (sizeof(u32) * __CHAR_BIT__) - nbits;
+    const u64 size_mask = (1u << static_cast<unsigned>(std::bit_width(size - 1))) - 1u;
+    return static_cast<std::size_t>((key * magic >> shift) & size_mask);
+}
+
+struct magic_array_result {
+    u64 magic{};
+    std::uint32_t attempts{};
+};
+
+// Search behind lookup_magic_array: fills table, which has one slot per mapping, and
+// returns a zero magic if none was found
+constexpr auto
+find_magic_array(
+    const auto& mappings, std::ranges::random_access_range auto& table,
+    std::uint32_t max_attempts = 10'000
+) -> magic_array_result
+{
+    const auto size = std::ranges::size(table);
+    const auto nbits = value_bits(mappings);
+
+    magic_array_result result{};
+    random::pcg rand_pcg{};
+
+    auto attempt_find_perfect_hash = [&]() {
+        result.magic = rand_pcg();
+        for (const auto& [key, value] : mappings) {
+            const auto slot = magic_array_slot(key, result.magic, nbits, size);
+            if (slot >= size) {
+                std::ranges::fill(table, 0);
+                result.magic = {};
+                return;
+            }
+
+            table[slot] = value;
+        }
+
+        for (const auto& [key, value] : mappings) {
+            if (table[magic_array_slot(key, result.magic, nbits, size)] != value) {
+                std::ranges::fill(table, 0);
+                result.magic = {};
+                return;
+            }
+        }
+    };
+
+    while (result.magic == 0 && max_attempts-- > 0) {
+        ++result.attempts;
+        attempt_find_perfect_hash();
+    }
+    return result;
+}
+
+template <const auto& Table, std::size_t Align = 0>
 requires PairRange<decltype(Table)>
 struct lookup_magic_array {
     using value_type = u64;
@@ -400,34 +581,7 @@ struct lookup_magic_array {
 
     consteval explicit lookup_magic_array(std::uint32_t max_attempts = 10'000) noexcept
     {
-        random::pcg rand_pcg{};
-
-        auto attempt_find_perfect_hash = [&]() {
-            magic_ = rand_pcg();
-            for (const auto& [key, value] : entries<Table>::MAPPINGS) {
-                u32 shift = u32(((key * magic_) >> SHIFT) & SIZE_MASK);
-                if (shift >= SIZE) {
-                    table_ = {};
-                    magic_ = {};
-                    return;
-                }
-
-                table_[shift] = to<mapped_type>(value);
-            }
-
-            for (const auto& [key, value] : entries<Table>::MAPPINGS) {
-                if (table_[(to<key_type>(key) * magic_ >> SHIFT) & SIZE_MASK]
-                    != to<mapped_type>(value)) {
-                    table_ = {};
-                    magic_ = {};
-                    return;
-                }
-            }
-        };
-
-        while (magic_ == 0 && max_attempts-- > 0) {
-            attempt_find_perfect_hash();
-        }
+        magic_ = find_magic_array(entries<Table>::MAPPINGS, table_, max_attempts).magic;
     }
 
     constexpr explicit
@@ -439,55 +593,810 @@ struct lookup_magic_array {
     constexpr result_type
     operator()(const auto& search_key) const noexcept
     {
-        return to<result_type>(
-            table_[((to<key_type>(search_key) * magic_ >> SHIFT)) & SIZE_MASK]
-        );
+        return value_at(slot(search_key));
+    }
+
+    constexpr result_type
+    value_at(std::size_t slot) const noexcept
+    {
+        return to<result_type>(table_[slot]);
+    }
+
+    constexpr std::size_t
+    slot(const auto& search_key) const noexcept
+    {
+        return magic_array_slot(to<key_type>(search_key), magic_, NBITS, SIZE);
+    }
+
+    constexpr const auto&
+    slots() const noexcept
+    {
+        return table_;
     }
 
 private:
     static constexpr std::size_t SIZE = Table.size();
-    static constexpr value_type MAX_BITS = []() {
-        u32 max = 0;
-        for (const auto& pair : entries<Table>::MAPPINGS) {
-            max = std::max(static_cast<u32>(pair.second), max);
-        }
-        // std::countl_zero counts differently, so use builtin
-        return std::countl_zero(max);
-    }();
-    static constexpr value_type NBITS = (sizeof(u32) * __CHAR_BIT__) - MAX_BITS;
-    static constexpr value_type SHIFT = (sizeof(u32) * __CHAR_BIT__) - NBITS;
-    static constexpr u64 SIZE_MASK =
-        (1u << static_cast<unsigned>(std::bit_width(SIZE - 1))) - 1u;
+    static constexpr u32 NBITS = value_bits(entries<Table>::MAPPINGS);
 
     value_type magic_{};
+    alignas(SLOT_ALIGNMENT<std::array<value_type, SIZE>, Align>)
     std::array<value_type, SIZE> table_{};
 };
 
-enum class LookupMethod : std::uint8_t { word, array, any };
+// Tables precomputed offline by gloss-gen. The search already happened, so these only
+// hold the resulting parameters and slots and can be passed straight to lookup<>.
+template <
+    typename Key, typename Mapped, typename Result, std::size_t Size,
+    std::size_t Align = 0>
+struct precomputed_pext {
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using result_type = Result;
 
-template <const auto& Table, LookupMethod Method = LookupMethod::any>
+    static_assert(
+        Size != std::dynamic_extent || Align == 0, "Align needs a fixed size slot array"
+    );
+
+    key_type mask;
+    alignas(SLOT_ALIGNMENT<slot_array<mapped_type, Size>, Align>)
+    slot_array<mapped_type, Size> table;
+
+    constexpr result_type
+    operator()(const auto& search_key) const noexcept
+    {
+        return value_at(slot(search_key));
+    }
+
+    constexpr result_type
+    value_at(std::size_t slot) const noexcept
+    {
+        return static_cast<result_type>(table[slot]);
+    }
+
+    constexpr std::size_t
+    slot(const auto& search_key) const noexcept
+    {
+        return static_cast<std::size_t>(pext(to<key_type>(search_key), mask));
+    }
+
+    constexpr const auto&
+    slots() const noexcept
+    {
+        return table;
+    }
+};
+
+// Maps a 64 bit hash onto [0, size) with the high half of a multiply instead of a
+// division
+constexpr u64
+fast_range(u64 hash, u64 size) noexcept
+{
+#if defined(__SIZEOF_INT128__)
+    return static_cast<u64>((static_cast<u128>(hash) * size) >> 64u);
+#else
+    const u64 hash_low = hash & 0xFFFF'FFFFu;
+    const u64 hash_high = hash >> 32u;
+    const u64 size_low = size & 0xFFFF'FFFFu;
+    const u64 size_high = size >> 32u;
+    const u64 cross = (hash_low * size_low >> 32u)
+                      + (hash_high * size_low & 0xFFFF'FFFFu)
+                      + (hash_low * size_high & 0xFFFF'FFFFu);
+    return hash_high * size_high + (hash_high * size_low >> 32u)
+           + (hash_low * size_high >> 32u) + (cross >> 32u);
+#endif
+}
+
+// Two level hash behind precomputed_displace, after CHD and PTHash. key * magic picks
+// a bucket of about DISPLACE_BUCKET_KEYS keys, and each bucket stores a small pilot
+// that moves all of its keys onto free slots. Searching per bucket rather than for the
+// whole key set keeps the table at about one slot per key.
+inline constexpr std::size_t DISPLACE_BUCKET_KEYS = 4;
+
+constexpr std::size_t
+displace_bucket_count(std::size_t keys) noexcept
+{
+    return std::max<std::size_t>(
+        1, (keys + DISPLACE_BUCKET_KEYS - 1) / DISPLACE_BUCKET_KEYS
+    );
+}
+
+// About 97% full
+constexpr std::size_t
+displace_slot_count(std::size_t keys) noexcept
+{
+    return keys + keys / 32 + 1;
+}
+
+// Injective for keys up to 64 bits; wider keys keep the high half of the product
+template <typename Hash>
+constexpr u64
+displace_hash(const auto& key, Hash magic) noexcept
+{
+    if constexpr (sizeof(Hash) > sizeof(u64)) {
+        return static_cast<u64>((static_cast<Hash>(key) * magic) >> 64u);
+    }
+    else {
+        return static_cast<u64>(key) * magic;
+    }
+}
+
+constexpr std::size_t
+displace_bucket(u64 hash, std::size_t bucket_count) noexcept
+{
+    return static_cast<std::size_t>(fast_range(hash, static_cast<u64>(bucket_count)));
+}
+
+constexpr u64
+displace_slot(u64 hash, u64 pilot, u64 slot_count) noexcept
+{
+    // Keys in one bucket share the high bits of hash, so mix after applying the pilot
+    return fast_range(
+        (hash ^ (pilot * 0x9E37'79B9'7F4A'7C15u)) * 0xBF58'476D'1CE4'E5B9u, slot_count
+    );
+}
+
+// Places every bucket of keys, largest first, at the lowest pilot below max_pilot
+// whose slots are all free. Fills pilots and returns false if some bucket has no such
+// pilot, e.g. because two of its keys share a hash.
+template <typename Hash>
+constexpr bool
+displace_keys(
+    const std::ranges::random_access_range auto& keys, Hash magic,
+    std::ranges::random_access_range auto& pilots, std::size_t slot_count,
+    u64 max_pilot = 1u << 16u
+)
+{
+    const auto bucket_count = std::ranges::size(pilots);
+
+    struct hashed {
+        std::size_t bucket;
+        u64 hash;
+    };
+    std::vector<hashed> hashes;
+    hashes.reserve(std::ranges::size(keys));
+    for (const auto& key : keys) {
+        const auto hash = displace_hash(key, magic);
+        hashes.push_back({displace_bucket(hash, bucket_count), hash});
+    }
+    std::ranges::sort(hashes, [](const hashed& lhs, const hashed& rhs) {
+        return lhs.bucket != rhs.bucket ? lhs.bucket < rhs.bucket : lhs.hash < rhs.hash;
+    });
+
+    struct bucket_span {
+        std::size_t first;
+        std::size_t size;
+    };
+    std::vector<bucket_span> buckets;
+    for (std::size_t i = 0; i < hashes.size();) {
+        std::size_t j = i + 1;
+        for (; j < hashes.size() && hashes[j].bucket == hashes[i].bucket; ++j) {
+            if (hashes[j].hash == hashes[j - 1].hash)
+                return false;
+        }
+        buckets.push_back({i, j - i});
+        i = j;
+    }
+    std::ranges::stable_sort(buckets, std::ranges::greater{}, &bucket_span::size);
+
+    std::ranges::fill(pilots, 0);
+    std::vector<bool> taken(slot_count);
+    std::vector<u64> placed;
+    for (const auto& bucket : buckets) {
+        const auto members = std::span{hashes}.subspan(bucket.first, bucket.size);
+        u64 pilot = 0;
+        for (; pilot < max_pilot; ++pilot) {
+            placed.clear();
+            for (const auto& member : members) {
+                const auto slot = displace_slot(member.hash, pilot, slot_count);
+                if (taken[slot] || std::ranges::find(placed, slot) != placed.end())
+                    break;
+                placed.push_back(slot);
+            }
+            if (placed.size() == members.size())
+                break;
+        }
+        if (pilot == max_pilot)
+            return false;
+
+        for (auto slot : placed)
+            taken[slot] = true;
+        pilots[members.front().bucket] =
+            static_cast<std::ranges::range_value_t<decltype(pilots)>>(pilot);
+    }
+    return true;
+}
+
+// Slot of key once every bucket has its pilot
+template <typename Hash>
+constexpr std::size_t
+displace_lookup(
+    const auto& key, Hash magic, const std::ranges::random_access_range auto& pilots,
+    std::size_t slot_count
+) noexcept
+{
+    const auto hash = displace_hash(key, magic);
+    const auto bucket = displace_bucket(hash, std::ranges::size(pilots));
+    return static_cast<std::size_t>(
+        displace_slot(hash, static_cast<u64>(pilots[bucket]), slot_count)
+    );
+}
+
+// Magic tried by one attempt of the search. A pure function of the attempt, so a
+// search split across threads, as in gloss-gen, can keep the lowest successful attempt
+// and still match find_displacement.
+template <typename Hash>
+constexpr Hash
+displace_magic(u64 attempt) noexcept
+{
+    // https://prng.di.unimi.it/splitmix64.c
+    auto splitmix64 = [](u64 state) {
+        state += 0x9E37'79B9'7F4A'7C15u;
+        state = (state ^ (state >> 30u)) * 0xBF58'476D'1CE4'E5B9u;
+        state = (state ^ (state >> 27u)) * 0x94D0'49BB'1331'11EBu;
+        return state ^ (state >> 31u);
+    };
+    const u64 low = splitmix64(attempt) | 1u;
+    if constexpr (sizeof(Hash) > sizeof(u64)) {
+        return (static_cast<Hash>(splitmix64(~attempt)) << 64u) | low;
+    }
+    else {
+        return low;
+    }
+}
+
+template <typename Hash>
+struct displacement_result {
+    Hash magic{};
+    std::uint32_t attempts{};
+};
+
+// Search behind precomputed_displace: fills pilots, which has one entry per bucket,
+// and returns a zero magic if no attempt placed every bucket
+template <typename Hash>
 constexpr auto
-lookup(const auto& search_key)
+find_displacement(
+    const std::ranges::random_access_range auto& keys,
+    std::ranges::random_access_range auto& pilots, std::size_t slot_count,
+    std::uint32_t max_attempts = 10'000
+) -> displacement_result<Hash>
+{
+    displacement_result<Hash> result{};
+    for (u64 attempt = 0; attempt < max_attempts; ++attempt) {
+        ++result.attempts;
+        const auto magic = displace_magic<Hash>(attempt);
+        if (displace_keys(keys, magic, pilots, slot_count)) {
+            result.magic = magic;
+            break;
+        }
+    }
+    return result;
+}
+
+template <
+    typename Key, typename Mapped, typename Result, typename Pilot, std::size_t Buckets,
+    std::size_t Size, std::size_t Align = 0>
+requires(Buckets > 0 && Size > 0)
+struct precomputed_displace {
+    using key_type = Key;
+    using mapped_type = Mapped;
+    using result_type = Result;
+    using hash_type =
+        std::conditional_t<(sizeof(key_type) > sizeof(u64)), key_type, u64>;
+
+    static_assert(
+        Size != std::dynamic_extent || Align == 0, "Align needs a fixed size slot array"
+    );
+
+    hash_type magic;
+    slot_array<Pilot, Buckets> pilots;
+    alignas(SLOT_ALIGNMENT<slot_array<mapped_type, Size>, Align>)
+    slot_array<mapped_type, Size> table;
+
+    constexpr result_type
+    operator()(const auto& search_key) const noexcept
+    {
+        return value_at(slot(search_key));
+    }
+
+    constexpr result_type
+    value_at(std::size_t slot) const noexcept
+    {
+        return static_cast<result_type>(table[slot]);
+    }
+
+    constexpr std::size_t
+    slot(const auto& search_key) const noexcept
+    {
+        return slot_of_hash(hash(search_key));
+    }
+
+    // slot() in two steps, so lookup_stream can prefetch the pilot a key needs before
+    // resolving its slot
+    constexpr u64
+    hash(const auto& search_key) const noexcept
+    {
+        return displace_hash(to<key_type>(search_key), magic);
+    }
+
+    constexpr const Pilot&
+    pilot(u64 hash) const noexcept
+    {
+        return pilots[displace_bucket(hash, pilots.size())];
+    }
+
+    constexpr std::size_t
+    slot_of_hash(u64 hash) const noexcept
+    {
+        return static_cast<std::size_t>(
+            displace_slot(hash, static_cast<u64>(pilot(hash)), table.size())
+        );
+    }
+
+    constexpr const auto&
+    slots() const noexcept
+    {
+        return table;
+    }
+};
+
+// Tables that are already built: emitted by gloss-gen, or a lookup type declared
+// directly, e.g. to give its slots an alignment
+template <typename T>
+inline constexpr bool IS_BUILT = false;
+
+template <
+    typename Key, typename Mapped, typename Result, std::size_t Size, std::size_t Align>
+inline constexpr bool IS_BUILT<
+    precomputed_pext<Key, Mapped, Result, Size, Align>> = true;
+
+template <
+    typename Key, typename Mapped, typename Result, typename Pilot, std::size_t Buckets,
+    std::size_t Size, std::size_t Align>
+inline constexpr bool IS_BUILT<
+    precomputed_displace<Key, Mapped, Result, Pilot, Buckets, Size, Align>> = true;
+
+template <const auto& Table, std::size_t Align>
+inline constexpr bool IS_BUILT<lookup_pext<Table, Align>> = true;
+
+template <const auto& Table, std::size_t Align>
+inline constexpr bool IS_BUILT<lookup_magic_array<Table, Align>> = true;
+
+template <typename T>
+concept BuiltTable = IS_BUILT<T>;
+
+enum class LookupMethod : std::uint8_t { word, array, any };
+
+template <const auto& Table, LookupMethod Method>
+consteval auto
+make_array_lookup()
+{
+    if constexpr (Method != LookupMethod::word) {
+#ifdef __BMI2__
+        return lookup_pext<Table>{};
+#else
+        if constexpr (constexpr lookup_magic_array<Table> TABLE_ARRAY{}; TABLE_ARRAY) {
+            return TABLE_ARRAY;
+        }
+#endif
+    }
+}
+
+template <const auto& Table, LookupMethod Method>
+consteval auto
+make_lookup()
 {
     if constexpr (Method != LookupMethod::array) {
         if constexpr (constexpr lookup_magic_lut<Table, u32> TABLE32{}; TABLE32) {
-            return TABLE32(search_key);
+            return TABLE32;
         }
         else if constexpr (constexpr lookup_magic_lut<Table, u64> TABLE64{}; TABLE64) {
-            return TABLE64(search_key);
+            return TABLE64;
+        }
+        else {
+            return make_array_lookup<Table, Method>();
         }
     }
-#ifdef __BMI2__
-    if constexpr (Method != LookupMethod::word) {
-        return lookup_pext<Table>{}(search_key);
+    else {
+        return make_array_lookup<Table, Method>();
     }
-#else
-    if constexpr (Method != LookupMethod::word) {
-        if constexpr (constexpr lookup_magic_array<Table> TABLE_ARRAY{}; TABLE_ARRAY) {
-            return TABLE_ARRAY(search_key);
+}
+
+// Searched once per table and method, not once per call site
+template <const auto& Table, LookupMethod Method>
+inline constexpr auto SEARCHED_LOOKUP = make_lookup<Table, Method>();
+
+template <const auto& Table, LookupMethod Method = LookupMethod::any>
+constexpr const auto&
+lookup_table() noexcept
+{
+    // Built tables carry their own hash parameters
+    if constexpr (BuiltTable<std::remove_cvref_t<decltype(Table)>>) {
+        return Table;
+    }
+    else {
+        return SEARCHED_LOOKUP<Table, Method>;
+    }
+}
+
+template <const auto& Table, LookupMethod Method = LookupMethod::any>
+constexpr auto
+lookup(const auto& search_key)
+{
+    return lookup_table<Table, Method>()(search_key);
+}
+
+template <typename T>
+concept SlotTable = requires(const T& table, std::size_t slot) {
+    table.slots();
+    table.value_at(slot);
+};
+
+// Two level tables read a pilot before they can resolve a slot
+template <typename T>
+concept PilotTable = SlotTable<T> && requires(const T& table, u64 hash) {
+    table.pilot(hash);
+    table.slot_of_hash(hash);
+};
+
+// Longest lookahead lookup_stream keeps, so the slots in flight fit a small ring on
+// the stack
+inline constexpr std::size_t MAX_STREAM_DISTANCE = 32;
+
+// Looks up every key in keys, writing results to out. Once a table no longer fits in
+// cache each lookup is a dependent miss, so the slot for the key `distance` ahead is
+// resolved and prefetched while the current one is read, and kept so it is not hashed
+// twice. Two level tables prefetch each key's pilot another `distance` earlier, so
+// resolving the slot doesn't stall on it. Word tables live in a register and skip the
+// prefetch.
+template <const auto& Table, LookupMethod Method = LookupMethod::any>
+constexpr auto
+lookup_stream(
+    const std::ranges::random_access_range auto& keys, auto out,
+    std::size_t distance = 16
+)
+{
+    using difference_type = std::ranges::range_difference_t<decltype(keys)>;
+    const auto& table = lookup_table<Table, Method>();
+    using table_type = std::remove_cvref_t<decltype(table)>;
+    const auto first = std::ranges::begin(keys);
+    const auto count = std::ranges::ssize(keys);
+
+    if constexpr (SlotTable<table_type>) {
+        if !consteval {
+            // Indexed by key position; a key is in flight for at most two distances
+            constexpr std::size_t RING = 2 * MAX_STREAM_DISTANCE;
+            std::array<u64, RING> hashes;
+            std::array<std::size_t, RING> slots;
+            auto ring = [](difference_type index) {
+                return static_cast<std::size_t>(index) % RING;
+            };
+
+            auto stage_pilot = [&](difference_type index) {
+                if constexpr (PilotTable<table_type>) {
+                    const auto hash = table.hash(first[index]);
+                    hashes[ring(index)] = hash;
+                    __builtin_prefetch(&table.pilot(hash));
+                }
+            };
+            auto stage_slot = [&](difference_type index) {
+                std::size_t slot{};
+                if constexpr (PilotTable<table_type>) {
+                    slot = table.slot_of_hash(hashes[ring(index)]);
+                }
+                else {
+                    slot = table.slot(first[index]);
+                }
+                slots[ring(index)] = slot;
+                __builtin_prefetch(&table.slots()[slot]);
+            };
+
+            const auto ahead = static_cast<difference_type>(std::min(
+                {distance, MAX_STREAM_DISTANCE, static_cast<std::size_t>(count)}
+            ));
+            for (difference_type i = 0; i < std::min(2 * ahead, count); ++i) {
+                stage_pilot(i);
+            }
+            for (difference_type i = 0; i < ahead; ++i) {
+                stage_slot(i);
+            }
+            for (difference_type i = 0; i < count; ++i, ++out) {
+                if (i + 2 * ahead < count) {
+                    stage_pilot(i + 2 * ahead);
+                }
+                if (i + ahead < count) {
+                    stage_slot(i + ahead);
+                }
+                *out = table.value_at(slots[ring(i)]);
+            }
+            return out;
+        }
+    }
+    for (difference_type i = 0; i < count; ++i, ++out) {
+        *out = table(first[i]);
+    }
+    return out;
+}
+
+template <typename R>
+using key_projection = std::conditional_t<PairRange<R>, project_first, std::identity>;
+
+// Narrowest word that holds every position in a table of Size keys
+template <std::size_t Size>
+using rank_type =
+    decltype(get_type<(Size <= 0xFFu) ? 1 : (Size <= 0xFFFFu) ? 2 : 4>());
+
+// The array search only checks that each key reads back its value, so keys mapping to
+// equal values may share a slot
+template <const auto& Table>
+requires PairRange<decltype(Table)>
+inline constexpr bool HAS_DISTINCT_SLOTS = []() {
+    const auto& table = lookup_table<Table, LookupMethod::array>();
+    std::vector<std::size_t> slots;
+    for (const auto& pair : Table) {
+        slots.push_back(table.slot(pair.first));
+    }
+    std::ranges::sort(slots);
+    return std::ranges::adjacent_find(slots) == slots.end();
+}();
+
+// Each key's position in table order, stored at the slot the array lookup already
+// assigns it, so ranking a table reuses its search instead of running another
+template <const auto& Table>
+requires PairRange<decltype(Table)> && HAS_DISTINCT_SLOTS<Table>
+inline constexpr auto SLOT_RANKS = []() {
+    const auto& table = lookup_table<Table, LookupMethod::array>();
+    using slots_type = std::remove_cvref_t<decltype(table.slots())>;
+
+    std::array<rank_type<Table.size()>, std::tuple_size_v<slots_type>> ranks{};
+    for (std::size_t i = 0; i < Table.size(); ++i) {
+        ranks[table.slot(Table[i].first)] = static_cast<rank_type<Table.size()>>(i);
+    }
+    return ranks;
+}();
+
+// Otherwise keys are searched as a table mapping each key to its position. Positions
+// are distinct, so that search cannot let two keys share a slot.
+template <const auto& Keys>
+inline constexpr auto KEY_RANKS = []() {
+    using packed = packed_keys<Keys, key_projection<decltype(Keys)>>;
+    constexpr auto SIZE = packed::SIZE;
+
+    std::array<std::pair<typename packed::key_type, rank_type<SIZE>>, SIZE> ranks;
+    for (std::size_t i = 0; i < SIZE; ++i) {
+        ranks[i] = {packed::KEYS[i], static_cast<rank_type<SIZE>>(i)};
+    }
+    return ranks;
+}();
+
+// Dense index of a key in [0, Table.size()), in table order, for indexing flat side
+// arrays. Like lookup, the key must be in the table. Tables of pairs rank through
+// their array lookup when it gives every key its own slot, and otherwise, like ranges
+// of bare keys, through a search of their own.
+template <const auto& Table, LookupMethod Method = LookupMethod::any>
+constexpr std::size_t
+index_of(const auto& search_key)
+{
+    if constexpr (Method != LookupMethod::word && requires { SLOT_RANKS<Table>; }) {
+        const auto& table = lookup_table<Table, LookupMethod::array>();
+        return static_cast<std::size_t>(SLOT_RANKS<Table>[table.slot(search_key)]);
+    }
+    else {
+        return static_cast<std::size_t>(lookup<KEY_RANKS<Table>, Method>(search_key));
+    }
+}
+
+template <const auto& Table>
+constexpr const auto&
+key_at(std::size_t index) noexcept
+{
+    assert(index < Table.size());
+    return key_projection<decltype(Table)>{}(Table[index]);
+}
+
+// Keys in table order, so key_at(i) is the i-th element
+template <const auto& Table>
+constexpr auto
+keys() noexcept
+{
+    return std::views::transform(Table, key_projection<decltype(Table)>{});
+}
+
+template <typename Hash>
+struct set_magic_result {
+    Hash magic{};
+    unsigned bits{};
+    std::uint32_t attempts{};
+};
+
+// Multiply-shift search for when pext isn't available: tries magics against a table
+// of 2^bits slots, doubling it whenever max_attempts magics all collide. Returns a
+// zero magic on failure.
+template <typename Hash>
+constexpr auto
+find_set_magic(
+    const std::ranges::random_access_range auto& keys, unsigned max_bits = 16,
+    std::uint32_t max_attempts = 10'000
+) -> set_magic_result<Hash>
+{
+    constexpr unsigned HASH_BITS = sizeof(Hash) * __CHAR_BIT__;
+    const auto size = std::ranges::size(keys);
+    random::pcg rand_pcg{};
+    std::uint32_t total_attempts{};
+
+    for (auto bits = std::max(1u, static_cast<unsigned>(std::bit_width(size - 1)));
+         bits <= max_bits; ++bits) {
+        // A random magic is collision free with odds of prod(1 - i / slots), so skip
+        // sizes where every attempt is all but certain to fail
+        const auto slots = static_cast<double>(std::size_t{1} << bits);
+        double odds = 1.0;
+        for (std::size_t i = 1; i < size; ++i) {
+            odds *= 1.0 - static_cast<double>(i) / slots;
+        }
+        if (odds * max_attempts < 0.01 && bits < max_bits) {
+            continue;
+        }
+
+        std::vector<std::uint32_t> seen(std::size_t{1} << bits);
+        for (std::uint32_t attempt = 1; attempt <= max_attempts; ++attempt) {
+            ++total_attempts;
+            Hash magic{};
+            for (std::size_t i = 0; i < sizeof(Hash) / sizeof(u32); ++i) {
+                magic = static_cast<Hash>(magic << 32u) | rand_pcg();
+            }
+            magic |= 1u;
+
+            bool unique = true;
+            for (const auto& key : keys) {
+                auto& cell = seen[static_cast<std::size_t>(
+                    (static_cast<Hash>(key) * magic) >> (HASH_BITS - bits)
+                )];
+                if (cell == attempt) {
+                    unique = false;
+                    break;
+                }
+                cell = attempt;
+            }
+            if (unique) {
+                return {magic, bits, total_attempts};
+            }
         }
     }
+    return {.attempts = total_attempts};
+}
+
+// Slot function of a set: pext under a unique mask where BMI2 is available and its
+// table is no larger, otherwise the top bits of key * magic. A zero slot_count means
+// neither was found.
+template <typename Key>
+struct set_hash {
+    using hash_type = std::conditional_t<(sizeof(Key) > sizeof(u64)), Key, u64>;
+
+    bool use_pext{};
+    Key mask{};
+    hash_type magic{};
+    unsigned bits{};
+    std::size_t slot_count{};
+    std::uint32_t attempts{};
+
+    constexpr std::size_t
+    operator()(Key key) const noexcept
+    {
+#ifdef __BMI2__
+        if (use_pext) {
+            return static_cast<std::size_t>(pext(key, mask));
+        }
+#endif
+        return static_cast<std::size_t>(
+            (static_cast<hash_type>(key) * magic)
+            >> ((sizeof(hash_type) * __CHAR_BIT__) - bits)
+        );
+    }
+};
+
+template <typename Key>
+constexpr auto
+find_set_hash(
+    const std::ranges::random_access_range auto& keys, unsigned max_bits = 16,
+    std::uint32_t max_attempts = 10'000
+) -> set_hash<Key>
+{
+    using hash_type = set_hash<Key>::hash_type;
+    const auto found = find_set_magic<hash_type>(keys, max_bits, max_attempts);
+
+    set_hash<Key> hash{
+        .magic = found.magic,
+        .bits = found.bits,
+        .slot_count = found.magic == 0 ? 0 : std::size_t{1} << found.bits,
+        .attempts = found.attempts,
+    };
+#ifdef __BMI2__
+    // pext saves the multiply, but a non-member can land on any slot below
+    // 2^popcount(mask), so its table has that many slots and only wins while no larger
+    const Key mask = find_unique_mask(keys);
+    unsigned mask_bits{};
+    for (Key rest = mask; rest != 0; rest &= static_cast<Key>(rest - 1)) {
+        ++mask_bits;
+    }
+    const auto slot_count = std::size_t{1} << std::min(mask_bits, max_bits);
+    if (mask_bits <= max_bits
+        && (hash.slot_count == 0 || slot_count <= hash.slot_count)) {
+        hash.use_pext = true;
+        hash.mask = mask;
+        hash.slot_count = slot_count;
+    }
 #endif
+    return hash;
 }
 
+// Fills slots, which has hash.slot_count entries, with each key at its own slot.
+// Unused slots hold the first key, which hashes elsewhere.
+constexpr void
+fill_set_slots(
+    const std::ranges::random_access_range auto& keys, const auto& hash,
+    std::ranges::random_access_range auto& slots
+)
+{
+    std::ranges::fill(slots, keys[0]);
+    for (const auto& key : keys) {
+        slots[hash(key)] = key;
+    }
+}
+
+// Perfect hash set: every key gets its own slot holding the key's packed word, so
+// membership is one hash and one whole-word compare. Unused slots hold a key that
+// hashes elsewhere, which no search key landing there can ever equal.
+template <const auto& Keys>
+requires std::ranges::random_access_range<decltype(Keys)>
+         && (!PairRange<decltype(Keys)>) && (Keys.size() > 0)
+struct set {
+    using key_type = packed_keys<Keys>::key_type;
+
+    static constexpr std::size_t
+    size() noexcept
+    {
+        return Keys.size();
+    }
+
+    static constexpr const auto&
+    slots() noexcept
+    {
+        return SLOTS;
+    }
+
+    constexpr bool
+    contains(const auto& search_key) const noexcept
+    {
+        using search_type = std::remove_cvref_t<decltype(search_key)>;
+        const auto key = to<key_type>(search_key);
+
+        // Anything wider than the key word would be truncated onto a member
+        if constexpr (requires { search_key.size(); }) {
+            if (search_key.size() > sizeof(key_type))
+                return false;
+        }
+        else if constexpr (std::is_convertible_v<search_type, const char*>) {
+            if (std::char_traits<char>::length(search_key) > sizeof(key_type))
+                return false;
+        }
+        else if constexpr (std::is_integral_v<search_type>) {
+            if (static_cast<search_type>(key) != search_key)
+                return false;
+        }
+        return SLOTS[HASH(key)] == key;
+    }
+
+private:
+    static constexpr const auto& KEYS = packed_keys<Keys>::KEYS;
+
+    static constexpr auto HASH = find_set_hash<key_type>(KEYS);
+    static_assert(HASH.slot_count != 0, "no perfect hash found for this key set");
+
+    // Aligned to the key width so a 128 bit slot never straddles a cache line
+    alignas(sizeof(key_type)) static constexpr auto SLOTS = []() {
+        std::array<key_type, HASH.slot_count> slots;
+        fill_set_slots(KEYS, HASH, slots);
+        return slots;
+    }();
+};
+
 } // namespace gloss
@@ -0,0 +1,656 @@
+// Differential fuzz-and-benchmark harness. Generates random key sets of several
+// shapes, runs every strategy's search on each, checks the resulting tables against
+// std::unordered_map and reports build success rate, search attempts, table bytes and
+// lookup latency per shape and strategy.
+//
+//   gloss_harness --sets 1000 --max-keys 64 --csv results.csv --label v0.1.0
+//
+// Exits non-zero if any built table disagrees with std::unordered_map.
+
+#include "gloss.hpp"
+
+#include <fmt/format.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+namespace {
+
+using gloss::u32;
+using gloss::u64;
+
+enum class Shape : std::uint8_t { dense_int, sparse_int, common_prefix, mixed_length };
+
+constexpr std::array SHAPES{
+    Shape::dense_int, Shape::sparse_int, Shape::common_prefix, Shape::mixed_length
+};
+
+constexpr std::string_view
+name(Shape shape)
+{
+    switch (shape) {
+        case Shape::dense_int:
+            return "dense_int";
+        case Shape::sparse_int:
+            return "sparse_int";
+        case Shape::common_prefix:
+            return "common_prefix";
+        case Shape::mixed_length:
+            return "mixed_length";
+    }
+    return "?";
+}
+
+struct options {
+    u32 sets{1000};
+    u32 min_keys{2};
+    u32 max_keys{64};
+    u32 lookups{4096};
+    u32 max_attempts{10'000};
+    u64 max_table_size{u64{1} << 20};
+    u64 seed{1};
+    std::string csv;
+    std::string label;
+};
+
+// ---- Key sets ----
+
+// Strings stay within the 16 byte key word; longer keys are truncated on packing
+constexpr std::size_t MAX_STRING = 16;
+
+struct key_set {
+    std::vector<u64> ints;
+    std::vector<std::string> strings;
+    std::vector<u32> values;
+
+    [[nodiscard]] std::size_t
+    size() const
+    {
+        return values.size();
+    }
+};
+
+std::string
+random_string(std::mt19937_64& rng, std::size_t length)
+{
+    constexpr std::string_view ALPHABET =
+        "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789_";
+    std::uniform_int_distribution<std::size_t> pick{0, ALPHABET.size() - 1};
+    std::string result(length, ' ');
+    for (auto& ch : result)
+        ch = ALPHABET[pick(rng)];
+    return result;
+}
+
+key_set
+generate(Shape shape, std::size_t size, std::mt19937_64& rng)
+{
+    key_set set;
+    switch (shape) {
+        case Shape::dense_int:
+            {
+                const u64 base =
+                    std::uniform_int_distribution<u64>{0, u64{1} << 31}(rng);
+                for (std::size_t i = 0; i < size; ++i)
+                    set.ints.push_back(base + i);
+                std::ranges::shuffle(set.ints, rng);
+                break;
+            }
+        case Shape::sparse_int:
+            {
+                std::unordered_set<u64> seen;
+                while (set.ints.size() < size) {
+                    if (const auto key = rng(); seen.insert(key).second)
+                        set.ints.push_back(key);
+                }
+                break;
+            }
+        case Shape::common_prefix:
+        case Shape::mixed_length:
+            {
+                std::string prefix;
+                if (shape == Shape::common_prefix) {
+                    prefix = random_string(
+                        rng, std::uniform_int_distribution<std::size_t>{3, 10}(rng)
+                    );
+                }
+                std::uniform_int_distribution<std::size_t> length{
+                    1, MAX_STRING - prefix.size()
+                };
+                std::unordered_set<std::string> seen;
+                while (set.strings.size() < size) {
+                    auto key = prefix + random_string(rng, length(rng));
+                    if (seen.insert(key).second)
+                        set.strings.push_back(std::move(key));
+                }
+                break;
+            }
+    }
+
+    set.values.resize(size);
+    std::iota(set.values.begin(), set.values.end(), 1u);
+    std::ranges::shuffle(set.values, rng);
+    return set;
+}
+
+// ---- Results ----
+
+struct outcome {
+    bool built{};
+    u64 attempts{};
+    u64 bytes{};
+    double ns{};
+    u64 mismatches{};
+};
+
+struct totals {
+    u64 sets{};
+    u64 built{};
+    u64 attempts{};
+    u64 bytes{};
+    double ns{};
+    u64 mismatches{};
+
+    void
+    add(const outcome& result)
+    {
+        ++sets;
+        mismatches += result.mismatches;
+        if (!result.built)
+            return;
+        ++built;
+        attempts += result.attempts;
+        bytes += result.bytes;
+        ns += result.ns;
+    }
+};
+
+// Best of a few passes over a stream of member keys, in ns per lookup
+template <typename Raw>
+double
+time_lookups(const std::vector<Raw>& stream, const auto& probe)
+{
+    static volatile u64 sink{};
+    double best = std::numeric_limits<double>::max();
+    for (int pass = 0; pass < 3; ++pass) {
+        u64 sum{};
+        const auto start = std::chrono::steady_clock::now();
+        for (const auto& key : stream)
+            sum += static_cast<u64>(probe(key));
+        const auto stop = std::chrono::steady_clock::now();
+        sink = sink + sum;
+        best = std::min(
+            best, std::chrono::duration<double, std::nano>(stop - start).count()
+                      / static_cast<double>(stream.size())
+        );
+    }
+    return best;
+}
+
+// Checks probe against the reference map for every member, then times it
+template <typename Raw>
+outcome
+verify(
+    outcome result, const std::vector<Raw>& members,
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream,
+    const auto& probe, std::string_view strategy
+)
+{
+    if (!result.built)
+        return result;
+    for (const auto& key : members) {
+        const auto expected = reference.at(key);
+        if (const auto actual = static_cast<u32>(probe(key)); actual != expected) {
+            if (result.mismatches++ == 0) {
+                fmt::print(
+                    stderr, "{}: mismatch, expected {} got {}\n", strategy, expected,
+                    actual
+                );
+            }
+        }
+    }
+    result.ns = time_lookups(stream, probe);
+    return result;
+}
+
+// ---- Strategies ----
+
+// Each strategy runs the library's own search and probes through the helpers or table
+// types its lookup uses, so the numbers are those of the real tables
+
+template <typename Key>
+std::vector<Key>
+keys_of(const std::vector<std::pair<Key, u32>>& mappings)
+{
+    std::vector<Key> keys;
+    for (const auto& [key, _] : mappings)
+        keys.push_back(key);
+    return keys;
+}
+
+template <typename Key, typename ValueType, typename Raw>
+outcome
+run_magic_lut(
+    const std::vector<std::pair<Key, u32>>& mappings, const std::vector<Raw>& members,
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream,
+    const options& opts, std::string_view strategy
+)
+{
+    const auto found = gloss::find_magic_lut<ValueType>(mappings, opts.max_attempts);
+    const auto nbits = gloss::value_bits(mappings);
+
+    outcome result{
+        .built = found.magic != 0 && found.lut != 0,
+        .attempts = found.attempts,
+        .bytes = 2 * sizeof(ValueType),
+    };
+    auto probe = [&](const Raw& key) {
+        return gloss::magic_lut_value(
+            found.lut, found.magic, gloss::to<Key>(key), nbits
+        );
+    };
+    return verify(result, members, reference, stream, probe, strategy);
+}
+
+template <typename Key, typename Raw>
+outcome
+run_magic_array(
+    const std::vector<std::pair<Key, u32>>& mappings, const std::vector<Raw>& members,
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream,
+    const options& opts
+)
+{
+    std::vector<u64> table(mappings.size());
+    const auto found = gloss::find_magic_array(mappings, table, opts.max_attempts);
+    const auto nbits = gloss::value_bits(mappings);
+
+    outcome result{
+        .built = found.magic != 0,
+        .attempts = found.attempts,
+        .bytes = sizeof(u64) * (table.size() + 1),
+    };
+    auto probe = [&](const Raw& key) {
+        return table[gloss::magic_array_slot(
+            gloss::to<Key>(key), found.magic, nbits, table.size()
+        )];
+    };
+    return verify(result, members, reference, stream, probe, "magic_array");
+}
+
+template <typename Key, typename Raw>
+outcome
+run_pext(
+    const std::vector<std::pair<Key, u32>>& mappings, const std::vector<Raw>& members,
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream,
+    const options& opts
+)
+{
+    const Key mask = gloss::find_unique_mask(keys_of(mappings));
+
+    // The table gloss-gen emits for this mask, narrowed as in gloss::lookup_pext
+    auto run = [&]<typename Narrow>() {
+        gloss::precomputed_pext<Narrow, u32, u32, std::dynamic_extent> table{
+            .mask = static_cast<Narrow>(mask), .table = {}
+        };
+        std::size_t size{};
+        for (const auto& [key, _] : mappings)
+            size = std::max(size, table.slot(key) + 1);
+
+        // Too sparse to emit, as gloss-gen would refuse it
+        if (size > opts.max_table_size)
+            return outcome{};
+
+        table.table.resize(size);
+        for (const auto& [key, value] : mappings)
+            table.table[table.slot(key)] = value;
+
+        outcome result{
+            .built = true, .bytes = sizeof(Narrow) + sizeof(u32) * table.table.size()
+        };
+        return verify(result, members, reference, stream, table, "pext");
+    };
+
+    switch (gloss::pext_word_bytes(mask)) {
+        case sizeof(u32):
+            return run.template operator()<u32>();
+        case sizeof(u64):
+            return run.template operator()<u64>();
+        default:
+            return run.template operator()<Key>();
+    }
+}
+
+// The two level table gloss-gen emits for large key sets
+template <typename Key, typename Raw>
+outcome
+run_displace(
+    const std::vector<std::pair<Key, u32>>& mappings, const std::vector<Raw>& members,
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream,
+    const options& opts
+)
+{
+    using table_type = gloss::precomputed_displace<
+        Key, u32, u32, gloss::u16, std::dynamic_extent, std::dynamic_extent>;
+
+    if (gloss::displace_slot_count(mappings.size()) > opts.max_table_size)
+        return outcome{};
+
+    table_type table{};
+    table.pilots.resize(gloss::displace_bucket_count(mappings.size()));
+    table.table.resize(gloss::displace_slot_count(mappings.size()));
+    const auto found = gloss::find_displacement<typename table_type::hash_type>(
+        keys_of(mappings), table.pilots, table.table.size(), opts.max_attempts
+    );
+    table.magic = found.magic;
+
+    outcome result{
+        .built = found.magic != 0,
+        .attempts = found.attempts,
+        .bytes = sizeof(table.magic) + sizeof(gloss::u16) * table.pilots.size()
+                 + sizeof(u32) * table.table.size(),
+    };
+    if (result.built) {
+        for (const auto& [key, value] : mappings)
+            table.table[table.slot(key)] = value;
+    }
+    return verify(result, members, reference, stream, table, "displace");
+}
+
+template <typename Key, typename Raw>
+outcome
+run_set(
+    const std::vector<std::pair<Key, u32>>& mappings, const std::vector<Raw>& members,
+    const std::vector<Raw>& strangers, const std::vector<Raw>& stream,
+    const std::unordered_map<Raw, u32>& reference, const options& opts
+)
+{
+    const auto keys = keys_of(mappings);
+    // Under -mbmi2 this picks pext whenever gloss::set would
+    const auto hash = gloss::find_set_hash<Key>(keys, 16, opts.max_attempts);
+
+    outcome result{
+        .built = hash.slot_count != 0 && hash.slot_count <= opts.max_table_size,
+        .attempts = hash.attempts,
+    };
+    if (!result.built)
+        return result;
+
+    std::vector<Key> slots(hash.slot_count);
+    gloss::fill_set_slots(keys, hash, slots);
+    result.bytes = sizeof(Key) * slots.size();
+
+    auto contains = [&](const Raw& raw) {
+        const auto key = gloss::to<Key>(raw);
+        return slots[hash(key)] == key;
+    };
+    for (const auto& key : members) {
+        if (!contains(key))
+            ++result.mismatches;
+    }
+    for (const auto& key : strangers) {
+        if (contains(key) != reference.contains(key))
+            ++result.mismatches;
+    }
+    if (result.mismatches != 0)
+        fmt::print(stderr, "set: {} membership mismatches\n", result.mismatches);
+
+    result.ns = time_lookups(stream, contains);
+    return result;
+}
+
+template <typename Raw>
+outcome
+run_unordered_map(
+    const std::unordered_map<Raw, u32>& reference, const std::vector<Raw>& stream
+)
+{
+    // Buckets plus one node (next pointer, cached hash, entry) per key
+    outcome result{
+        .built = true,
+        .bytes = sizeof(void*) * reference.bucket_count()
+                 + (2 * sizeof(void*) + sizeof(std::pair<const Raw, u32>))
+                       * reference.size(),
+    };
+    result.ns = time_lookups(stream, [&](const Raw& key) {
+        return reference.find(key)->second;
+    });
+    return result;
+}
+
+// ---- Driver ----
+
+using report = std::map<std::pair<Shape, std::string>, totals>;
+
+template <typename Key, typename Raw>
+void
+run_all(
+    Shape shape, const std::vector<Raw>& members, const std::vector<Raw>& strangers,
+    const key_set& set, const options& opts, std::mt19937_64& rng, report& out
+)
+{
+    std::vector<std::pair<Key, u32>> mappings;
+    std::unordered_map<Raw, u32> reference;
+    for (std::size_t i = 0; i < set.size(); ++i) {
+        mappings.emplace_back(gloss::to<Key>(members[i]), set.values[i]);
+        reference.emplace(members[i], set.values[i]);
+    }
+
+    std::vector<Raw> stream;
+    std::uniform_int_distribution<std::size_t> pick{0, members.size() - 1};
+    for (u32 i = 0; i < opts.lookups; ++i)
+        stream.push_back(members[pick(rng)]);
+
+    auto record = [&](std::string strategy, const outcome& result) {
+        out[{shape, std::move(strategy)}].add(result);
+    };
+    record(
+        "magic_lut32",
+        run_magic_lut<Key, u32>(
+            mappings, members, reference, stream, opts, "magic_lut32"
+        )
+    );
+    record(
+        "magic_lut64",
+        run_magic_lut<Key, u64>(
+            mappings, members, reference, stream, opts, "magic_lut64"
+        )
+    );
+    record(
+        "magic_array", run_magic_array<Key>(mappings, members, reference, stream, opts)
+    );
+    record("pext", run_pext<Key>(mappings, members, reference, stream, opts));
+    record("displace", run_displace<Key>(mappings, members, reference, stream, opts));
+    record("set", run_set<Key>(mappings, members, strangers, stream, reference, opts));
+    record("unordered_map", run_unordered_map(reference, stream));
+}
+
+// Dispatches on the key word gloss::entries would pack these keys into
+void
+run_set_of(
+    Shape shape, const key_set& set, const options& opts, std::mt19937_64& rng,
+    report& out
+)
+{
+    if (!set.ints.empty()) {
+        // Stray keys outside the set, for membership checks
+        std::vector<u64> strangers;
+        for (std::size_t i = 0; i < set.size(); ++i)
+            strangers.push_back(set.ints[i] + set.size());
+
+        if (std::ranges::max(set.ints) <= std::numeric_limits<u32>::max())
+            run_all<u32>(shape, set.ints, strangers, set, opts, rng, out);
+        else
+            run_all<u64>(shape, set.ints, strangers, set, opts, rng, out);
+        return;
+    }
+
+    std::vector<std::string_view> members(set.strings.begin(), set.strings.end());
+    std::vector<std::string> stranger_storage;
+    for (const auto& key : set.strings)
+        stranger_storage.push_back(key.substr(0, key.size() - 1) + '#');
+    std::vector<std::string_view> strangers(
+        stranger_storage.begin(), stranger_storage.end()
+    );
+
+    std::size_t max_size{};
+    for (const auto& key : set.strings)
+        max_size = std::max(max_size, key.size());
+
+    if (max_size <= sizeof(gloss::u8))
+        run_all<gloss::u8>(shape, members, strangers, set, opts, rng, out);
+    else if (max_size <= sizeof(gloss::u16))
+        run_all<gloss::u16>(shape, members, strangers, set, opts, rng, out);
+    else if (max_size <= sizeof(u32))
+        run_all<u32>(shape, members, strangers, set, opts, rng, out);
+    else if (max_size <= sizeof(u64))
+        run_all<u64>(shape, members, strangers, set, opts, rng, out);
+    else
+        run_all<gloss::u128>(shape, members, strangers, set, opts, rng, out);
+}
+
+constexpr std::string_view USAGE =
+    "usage: gloss_harness [options]\n"
+    "\n"
+    "  --sets N           key sets per shape (default: 1000)\n"
+    "  --min-keys N       smallest key set (default: 2)\n"
+    "  --max-keys N       largest key set (default: 64)\n"
+    "  --lookups N        lookups timed per table (default: 4096)\n"
+    "  --max-attempts N   magic search attempts, as in the library (default: 10000)\n"
+    "  --max-table-size N largest table to build, in slots, as in gloss-gen\n"
+    "                     (default: 1048576)\n"
+    "  --seed N           random seed (default: 1)\n"
+    "  --csv FILE         append results to FILE as CSV\n"
+    "  --label TEXT       first CSV column, e.g. a release tag\n";
+
+options
+parse_args(int argc, char** argv)
+{
+    options opts;
+    const std::vector<std::string_view> args(argv + 1, argv + argc);
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const auto flag = args[i];
+        if (flag == "--help" || flag == "-h") {
+            fmt::print("{}", USAGE);
+            std::exit(0);
+        }
+        if (i + 1 >= args.size()) {
+            fmt::print(stderr, "missing value for {}\n{}", flag, USAGE);
+            std::exit(2);
+        }
+        const std::string value{args[++i]};
+        auto number = [&]() { return std::strtoull(value.c_str(), nullptr, 10); };
+
+        if (flag == "--sets")
+            opts.sets = static_cast<u32>(number());
+        else if (flag == "--min-keys")
+            opts.min_keys = static_cast<u32>(number());
+        else if (flag == "--max-keys")
+            opts.max_keys = static_cast<u32>(number());
+        else if (flag == "--lookups")
+            opts.lookups = static_cast<u32>(number());
+        else if (flag == "--max-attempts")
+            opts.max_attempts = static_cast<u32>(number());
+        else if (flag == "--max-table-size")
+            opts.max_table_size = number();
+        else if (flag == "--seed")
+            opts.seed = number();
+        else if (flag == "--csv")
+            opts.csv = value;
+        else if (flag == "--label")
+            opts.label = value;
+        else {
+            fmt::print(stderr, "unknown option '{}'\n{}", flag, USAGE);
+            std::exit(2);
+        }
+    }
+    if (opts.min_keys < 1 || opts.max_keys < opts.min_keys || opts.lookups == 0) {
+        fmt::print(stderr, "need 1 <= --min-keys <= --max-keys and --lookups > 0\n");
+        std::exit(2);
+    }
+    return opts;
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    const auto opts = parse_args(argc, argv);
+    std::mt19937_64 rng{opts.seed};
+    std::uniform_int_distribution<std::size_t> size{opts.min_keys, opts.max_keys};
+
+    report results;
+    for (auto shape : SHAPES) {
+        for (u32 i = 0; i < opts.sets; ++i)
+            run_set_of(shape, generate(shape, size(rng), rng), opts, rng, results);
+    }
+
+    std::FILE* csv = nullptr;
+    if (!opts.csv.empty()) {
+        csv = std::fopen(opts.csv.c_str(), "a");
+        if (csv == nullptr) {
+            fmt::print(stderr, "cannot open {}\n", opts.csv);
+            return 2;
+        }
+        if (std::ftell(csv) == 0) {
+            fmt::print(
+                csv, "label,shape,strategy,sets,built,success_rate,avg_attempts,"
+                     "avg_bytes,ns_per_lookup,mismatches\n"
+            );
+        }
+    }
+
+    fmt::print(
+        "{:<14} {:<14} {:>8} {:>12} {:>12} {:>10}\n", "shape", "strategy", "built",
+        "attempts", "bytes", "ns/lookup"
+    );
+    u64 mismatches{};
+    for (const auto& [key, total] : results) {
+        const auto& [shape, strategy] = key;
+        const auto built = static_cast<double>(std::max<u64>(total.built, 1));
+        const double rate =
+            100.0 * static_cast<double>(total.built) / static_cast<double>(total.sets);
+        const double attempts = static_cast<double>(total.attempts) / built;
+        const double bytes = static_cast<double>(total.bytes) / built;
+        const double ns = total.ns / built;
+        mismatches += total.mismatches;
+
+        fmt::print(
+            "{:<14} {:<14} {:>7.1f}% {:>12.1f} {:>12.1f} {:>10.2f}\n", name(shape),
+            strategy, rate, attempts, bytes, ns
+        );
+        if (csv != nullptr) {
+            fmt::print(
+                csv, "{},{},{},{},{},{:.4f},{:.2f},{:.2f},{:.3f},{}\n", opts.label,
+                name(shape), strategy, total.sets, total.built, rate / 100.0, attempts,
+                bytes, ns, total.mismatches
+            );
+        }
+    }
+    if (csv != nullptr)
+        std::fclose(csv);
+
+    if (mismatches != 0) {
+        fmt::print(
+            stderr, "{} lookups disagreed with std::unordered_map\n", mismatches
+        );
+        return 1;
+    }
+    return 0;
+}
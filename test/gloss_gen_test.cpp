@@ -0,0 +1,133 @@
+#include "codes.hpp"
+#include "codes_array.hpp"
+#include "dial_codes.hpp"
+#include "gloss.hpp"
+#include "instruments.hpp"
+#include "limits.hpp"
+#include "tickers.hpp"
+
+#include <catch2/catch_test_macros.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+using gloss::lookup;
+
+// Headers are generated from test/data by gloss-gen at build time
+
+TEST_CASE("Generated string table", "[gen]")
+{
+    static_assert(lookup<generated::tickers>("BTC") == 0);
+    static_assert(lookup<generated::tickers>("DOGE") == 3);
+    static_assert(lookup<generated::tickers>("LI\"NK") == 7);
+
+    REQUIRE(lookup<generated::tickers>(std::string_view{"ETH"}) == 1);
+    REQUIRE(lookup<generated::tickers>(std::string_view{"SOL"}) == 2);
+    REQUIRE(lookup<generated::tickers>(std::string_view{"ADA"}) == 4);
+    REQUIRE(lookup<generated::tickers>(std::string_view{"XRP"}) == 5);
+    REQUIRE(lookup<generated::tickers>(std::string_view{"AVAX"}) == 6);
+}
+
+TEST_CASE("Generated int table", "[gen]")
+{
+    static_assert(lookup<generated::codes>(404u) == 3);
+
+    constexpr std::uint32_t CODES[] = {200, 201, 404, 418, 500, 503};
+    for (std::uint32_t i = 0; i < 6; ++i) {
+        REQUIRE(lookup<generated::codes>(CODES[i]) == i + 1);
+    }
+}
+
+TEST_CASE("Generated array table", "[gen]")
+{
+    // Emitted with METHOD array, so this covers the displacement table even under BMI2
+    static_assert(lookup<generated::codes_array>(418u) == 4);
+
+    REQUIRE(lookup<generated::codes_array>(200u) == 1);
+    REQUIRE(lookup<generated::codes_array>(503u) == 6);
+}
+
+TEST_CASE("Generated table keeps the spelling of numeric keys", "[gen]")
+{
+    static_assert(lookup<generated::dial_codes>("007") == 1);
+    static_assert(lookup<generated::dial_codes>("7") == 2);
+
+    REQUIRE(lookup<generated::dial_codes>(std::string_view{"0044"}) == 3);
+    REQUIRE(lookup<generated::dial_codes>(std::string_view{"44"}) == 4);
+    REQUIRE(lookup<generated::dial_codes>(std::string_view{"UK"}) == 5);
+}
+
+TEST_CASE("Generated table with full width values", "[gen]")
+{
+    static_assert(
+        lookup<generated::limits>(0u) == std::numeric_limits<std::uint64_t>::max()
+    );
+    static_assert(lookup<generated::limits>(1u) == std::uint64_t{1} << 63u);
+    static_assert(lookup<generated::limits>(2u) == 0);
+}
+
+TEST_CASE("Generated large table", "[gen]")
+{
+    std::ifstream csv{GLOSS_TEST_DATA_DIR "/instruments.csv"};
+    REQUIRE(csv);
+
+    using table = std::remove_cvref_t<decltype(generated::instruments)>;
+    std::vector<table::key_type> keys;
+    for (std::string line; std::getline(csv, line);) {
+        const auto comma = line.find(',');
+        if (line.starts_with('#') || line.starts_with("symbol,"))
+            continue;
+        const auto symbol = std::string_view{line}.substr(0, comma);
+        REQUIRE(
+            lookup<generated::instruments>(symbol) == std::stoul(line.substr(comma + 1))
+        );
+        keys.push_back(gloss::to<table::key_type>(symbol));
+    }
+    REQUIRE(keys.size() == 5000);
+
+    // About one slot per key, where a single level search needs hundreds
+    static_assert(generated::instruments.slots().size() <= 2 * 5000);
+
+    // gloss-gen splits the library's search across threads but must land on the same
+    // magic and pilots
+    std::vector<std::uint64_t> pilots(generated::instruments.pilots.size());
+    const auto found = gloss::find_displacement<table::hash_type>(
+        keys, pilots, generated::instruments.table.size()
+    );
+    REQUIRE(found.magic == generated::instruments.magic);
+    REQUIRE(std::ranges::equal(pilots, generated::instruments.pilots));
+
+    // Streaming resolves each pilot and slot in stages ahead of the read
+    std::vector<std::uint32_t> expected;
+    for (auto key : keys)
+        expected.push_back(lookup<generated::instruments>(key));
+    for (std::size_t distance : {0uz, 1uz, 16uz, 5000uz}) {
+        std::vector<std::uint32_t> out(keys.size());
+        gloss::lookup_stream<generated::instruments>(keys, out.begin(), distance);
+        REQUIRE(out == expected);
+    }
+}
+
+TEST_CASE("Generated table alignment", "[gen]")
+{
+    // ALIGN applies to the slot array itself, not the object holding it
+    const auto* slots = generated::codes_array.table.data();
+    REQUIRE(reinterpret_cast<std::uintptr_t>(slots) % 64 == 0);
+}
+
+TEST_CASE("Stream lookup over generated table", "[gen]")
+{
+    const std::vector<std::string_view> keys{"SOL", "BTC", "AVAX", "SOL", "XRP"};
+    std::vector<std::uint8_t> out(keys.size());
+
+    gloss::lookup_stream<generated::tickers>(keys, out.begin(), 2);
+    REQUIRE(out == std::vector<std::uint8_t>{2, 0, 6, 2, 5});
+}
@@ -3,8 +3,10 @@
 #include <catch2/catch_test_macros.hpp>
 
 #include <cstddef>
+#include <cstdint>
 
 #include <array>
+#include <vector>
 
 // TODO: clean these up. They're testing implementation details, which isn't ideal. Find
 // cleaner way to do this
@@ -184,6 +186,238 @@ TEST_CASE("Many int to int mappings", "[library]")
     }
 }
 
+// Stream tests
+
+TEST_CASE("Stream lookup over array table", "[library]")
+{
+    static constexpr std::size_t SIZE = 64;
+    static constexpr std::array<std::pair<uint32_t, uint32_t>, SIZE> TEST = []() {
+        std::array<std::pair<uint32_t, uint32_t>, SIZE> arr;
+        for (std::size_t i = 0; i < arr.size(); ++i) {
+            arr[i] = {i * 7, i + 13};
+        }
+        return arr;
+    }();
+
+    std::vector<uint32_t> keys;
+    for (std::uint32_t i = 0; i < 1000; ++i) {
+        keys.push_back((i * 37 % SIZE) * 7);
+    }
+    std::vector<uint32_t> out(keys.size());
+
+    // Distances shorter than, equal to, and longer than the key count
+    for (std::size_t distance : {0uz, 1uz, 16uz, 5000uz}) {
+        auto end = gloss::lookup_stream<TEST, LookupMethod::array>(
+            keys, out.begin(), distance
+        );
+        REQUIRE(end == out.end());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            REQUIRE(out[i] == keys[i] / 7 + 13);
+        }
+    }
+}
+
+TEST_CASE("Stream lookup over word table", "[library]")
+{
+    static constexpr auto TEST = std::array{
+        std::pair<std::string_view, uint8_t>{"one", 1},
+        std::pair<std::string_view, uint8_t>{"two", 2}
+    };
+    static constexpr auto RESULT = []() {
+        constexpr std::array<std::string_view, 3> KEYS{"two", "one", "two"};
+        std::array<uint8_t, 3> out{};
+        gloss::lookup_stream<TEST, LookupMethod::word>(KEYS, out.begin());
+        return out;
+    }();
+    static_assert(RESULT == std::array<uint8_t, 3>{2, 1, 2});
+}
+
+TEST_CASE("Aligned slot arrays", "[library]")
+{
+    static constexpr auto TEST = std::array{
+        std::pair<uint32_t, uint32_t>{3, 30}, std::pair<uint32_t, uint32_t>{8, 80},
+        std::pair<uint32_t, uint32_t>{21, 210}
+    };
+    static constexpr gloss::lookup_pext<TEST, 64> PEXT{};
+    static constexpr gloss::lookup_magic_array<TEST, 64> ARRAY{};
+    static_assert(ARRAY);
+
+    REQUIRE(reinterpret_cast<std::uintptr_t>(PEXT.slots().data()) % 64 == 0);
+    REQUIRE(reinterpret_cast<std::uintptr_t>(ARRAY.slots().data()) % 64 == 0);
+
+    // Declared tables plug straight into lookup
+    static_assert(lookup<PEXT>(8u) == 80);
+    static_assert(lookup<ARRAY>(21u) == 210);
+
+    std::array<uint32_t, 3> out{};
+    gloss::lookup_stream<ARRAY>(std::array<uint32_t, 3>{21, 3, 8}, out.begin());
+    REQUIRE(out == std::array<uint32_t, 3>{210, 30, 80});
+}
+
+// Rank tests
+
+TEST_CASE("Rank and unrank", "[library]")
+{
+    static constexpr auto TEST = std::array{
+        std::pair<std::string_view, uint32_t>{"AAPL", 100},
+        std::pair<std::string_view, uint32_t>{"MSFT", 200},
+        std::pair<std::string_view, uint32_t>{"NVDA", 300},
+        std::pair<std::string_view, uint32_t>{"AMZN", 400},
+        std::pair<std::string_view, uint32_t>{"GOOG", 500}
+    };
+
+    static_assert(gloss::index_of<TEST>("AAPL") == 0);
+    static_assert(gloss::index_of<TEST>("GOOG") == 4);
+    static_assert(gloss::key_at<TEST>(2) == "NVDA");
+
+    std::array<bool, TEST.size()> seen{};
+    for (std::size_t i = 0; i < TEST.size(); ++i) {
+        const auto key = gloss::key_at<TEST>(i);
+        REQUIRE(gloss::index_of<TEST, LookupMethod::array>(key) == i);
+        seen[gloss::index_of<TEST>(key)] = true;
+    }
+    REQUIRE(std::ranges::all_of(seen, std::identity{}));
+}
+
+TEST_CASE("Rank keys with repeated values", "[library]")
+{
+    // Keys with equal values may share an array slot, so their ranks can't live there
+    static constexpr auto TEST = std::array{
+        std::pair<uint32_t, uint32_t>{10, 1}, std::pair<uint32_t, uint32_t>{20, 1},
+        std::pair<uint32_t, uint32_t>{30, 1}, std::pair<uint32_t, uint32_t>{40, 2}
+    };
+
+    static_assert(gloss::index_of<TEST>(20u) == 1);
+    static_assert(gloss::index_of<TEST>(30u) == 2);
+
+    for (std::size_t i = 0; i < TEST.size(); ++i) {
+        REQUIRE(gloss::index_of<TEST>(TEST[i].first) == i);
+        REQUIRE(gloss::index_of<TEST, LookupMethod::array>(TEST[i].first) == i);
+        REQUIRE(gloss::index_of<TEST, LookupMethod::word>(TEST[i].first) == i);
+    }
+}
+
+TEST_CASE("Rank over key range", "[library]")
+{
+    static constexpr std::size_t SIZE = 32;
+    static constexpr auto KEYS = []() {
+        std::array<uint32_t, SIZE> keys;
+        for (std::size_t i = 0; i < SIZE; ++i) {
+            keys[i] = static_cast<uint32_t>(1000 + (SIZE - i) * 8);
+        }
+        return keys;
+    }();
+
+    for (std::size_t i = 0; i < SIZE; ++i) {
+        REQUIRE(gloss::index_of<KEYS, LookupMethod::array>(KEYS[i]) == i);
+        REQUIRE(gloss::key_at<KEYS>(i) == KEYS[i]);
+    }
+}
+
+TEST_CASE("Iterate keys in table order", "[library]")
+{
+    static constexpr auto TEST = std::array{
+        std::pair<const char*, uint8_t>{"hi",  8},
+        std::pair<const char*, uint8_t>{"bye", 6}
+    };
+
+    static_assert(std::ranges::size(gloss::keys<TEST>()) == 2);
+    static_assert(std::string_view{*gloss::keys<TEST>().begin()} == "hi");
+
+    std::size_t index = 0;
+    for (const char* key : gloss::keys<TEST>()) {
+        REQUIRE(gloss::index_of<TEST>(key) == index++);
+    }
+}
+
+// Set tests
+
+TEST_CASE("Keyword set", "[library]")
+{
+    static constexpr auto KEYWORDS = std::array<std::string_view, 12>{
+        "if",     "else",  "for",   "while", "do",     "return",
+        "switch", "case",  "break", "auto",  "struct", "continue"
+    };
+    static constexpr gloss::set<KEYWORDS> SET{};
+
+    static_assert(SET.size() == 12);
+    static_assert(SET.contains("while"));
+    static_assert(SET.contains(std::string_view{"continue"}));
+    static_assert(!SET.contains("whilst"));
+
+    for (auto keyword : KEYWORDS) {
+        REQUIRE(SET.contains(keyword));
+        REQUIRE(SET.contains(std::string{keyword}));
+    }
+    for (std::string_view other : {"", "i", "fo", "fore", "Auto", "continues", "x"}) {
+        REQUIRE_FALSE(SET.contains(other));
+    }
+}
+
+TEST_CASE("Long keyword set", "[library]")
+{
+    static constexpr auto KEYWORDS = std::array<const char*, 4>{
+        "reinterpret_cast", "static_assert", "thread_local", "const_cast"
+    };
+    static constexpr gloss::set<KEYWORDS> SET{};
+
+    REQUIRE(SET.contains("reinterpret_cast"));
+    REQUIRE(SET.contains("static_assert"));
+    REQUIRE(SET.contains("thread_local"));
+    REQUIRE(SET.contains("const_cast"));
+    REQUIRE_FALSE(SET.contains("dynamic_cast"));
+    REQUIRE_FALSE(SET.contains("reinterpret_casts"));
+    REQUIRE_FALSE(SET.contains("const"));
+}
+
+TEST_CASE("Set table size", "[library]")
+{
+    static constexpr auto KEYWORDS = std::array<std::string_view, 32>{
+        "alignas",  "alignof", "auto",    "bool",     "break",     "case",
+        "catch",    "char",    "class",   "const",    "consteval", "constexpr",
+        "continue", "default", "delete",  "do",       "double",    "else",
+        "enum",     "explicit", "extern", "false",    "float",     "for",
+        "friend",   "goto",    "if",      "inline",   "int",       "long",
+        "mutable",  "namespace"
+    };
+    static constexpr gloss::set<KEYWORDS> SET{};
+
+    // 16 byte words, so at most four slots per keyword, with or without pext
+    static_assert(sizeof(SET.slots()) <= 32 * 4 * 16);
+
+    for (auto keyword : KEYWORDS) {
+        REQUIRE(SET.contains(keyword));
+    }
+    REQUIRE_FALSE(SET.contains("struct"));
+}
+
+TEST_CASE("Set probed with non-members", "[library]")
+{
+    // Under BMI2 the mask keeps two bits, and 3 lands past the members' largest slot
+    static constexpr auto FLAGS = std::array<unsigned, 3>{1, 2, 4};
+    static constexpr gloss::set<FLAGS> SET{};
+
+    static_assert(!SET.contains(3u));
+    for (unsigned key = 0; key < 64; ++key) {
+        REQUIRE(SET.contains(key) == (std::ranges::find(FLAGS, key) != FLAGS.end()));
+    }
+}
+
+TEST_CASE("Int set", "[library]")
+{
+    static constexpr auto CODES = std::array<uint16_t, 5>{200, 204, 404, 500, 503};
+    static constexpr gloss::set<CODES> SET{};
+
+    for (auto code : CODES) {
+        REQUIRE(SET.contains(code));
+    }
+    for (int code = 0; code < 1000; ++code) {
+        REQUIRE(SET.contains(code) == (std::ranges::find(CODES, code) != CODES.end()));
+    }
+    REQUIRE_FALSE(SET.contains(200 + 65536));
+    REQUIRE_FALSE(SET.contains(-1));
+}
+
 // to<T> tests
 
 TEST_CASE("to<T>(const char*)", "[library]")
@@ -0,0 +1,826 @@
+// gloss-gen: run the perfect hash search once, offline, and emit a header of plain
+// constexpr tables that plug into gloss::lookup<>.
+//
+//   gloss-gen --input tickers.csv --output tickers.hpp --name tickers
+//
+// Input is either CSV (`key,value` per line, `#` comments, optional header row) or
+// JSON (an object of "key": value, or an array of [key, value] pairs).
+
+#include "gloss.hpp"
+
+#include <fmt/format.h>
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace {
+
+using gloss::u128;
+using gloss::u32;
+using gloss::u64;
+
+enum class KeyKind : std::uint8_t { automatic, integer, string };
+enum class Method : std::uint8_t { any, pext, array };
+
+struct options {
+    std::string input;
+    std::string output;
+    std::string name;
+    std::string name_space;
+    std::string format;
+    std::string result_type;
+    std::vector<std::string> includes;
+    KeyKind key_kind{KeyKind::automatic};
+    Method method{Method::any};
+    u32 threads{std::max(1u, std::thread::hardware_concurrency())};
+    u32 attempts{10'000};
+    u64 max_table_size{u64{1} << 20};
+    u64 align{};
+};
+
+using raw_key = std::variant<u64, std::string>;
+
+// text is the key as written, so a numeric looking key that ends up as a string keeps
+// its spelling, e.g. leading zeros
+struct raw_entry {
+    raw_key key;
+    u64 value;
+    std::string text;
+};
+
+struct error : std::runtime_error {
+    using std::runtime_error::runtime_error;
+};
+
+// ---- Input parsing ----
+
+std::optional<u64>
+parse_unsigned(std::string_view text)
+{
+    u64 value{};
+    const auto* end = text.data() + text.size();
+    auto [ptr, ec] = std::from_chars(text.data(), end, value);
+    if (ec != std::errc{} || ptr != end || text.empty())
+        return std::nullopt;
+    return value;
+}
+
+std::string_view
+trim(std::string_view text)
+{
+    constexpr std::string_view WHITESPACE = " \t\r\n";
+    const auto first = text.find_first_not_of(WHITESPACE);
+    if (first == std::string_view::npos)
+        return {};
+    const auto last = text.find_last_not_of(WHITESPACE);
+    return text.substr(first, last - first + 1);
+}
+
+std::vector<raw_entry>
+parse_csv(const std::string& contents)
+{
+    std::vector<raw_entry> result;
+    std::istringstream stream{contents};
+    std::string line;
+    std::size_t line_number{};
+    bool first_row = true;
+
+    while (std::getline(stream, line)) {
+        ++line_number;
+        std::string_view rest = trim(line);
+        if (rest.empty() || rest.front() == '#')
+            continue;
+        const bool header_allowed = std::exchange(first_row, false);
+
+        raw_key key;
+        std::string key_text;
+        if (rest.front() == '"') {
+            std::string text;
+            std::size_t pos = 1;
+            for (;; ++pos) {
+                if (pos >= rest.size()) {
+                    throw error{
+                        fmt::format("line {}: unterminated quoted key", line_number)
+                    };
+                }
+                if (rest[pos] == '"') {
+                    if (pos + 1 < rest.size() && rest[pos + 1] == '"') {
+                        text += '"';
+                        ++pos;
+                        continue;
+                    }
+                    break;
+                }
+                text += rest[pos];
+            }
+            key_text = text;
+            key = std::move(text);
+            rest = trim(rest.substr(pos + 1));
+            if (rest.empty() || rest.front() != ',') {
+                throw error{
+                    fmt::format("line {}: expected ',' after key", line_number)
+                };
+            }
+            rest.remove_prefix(1);
+        }
+        else {
+            const auto comma = rest.find(',');
+            if (comma == std::string_view::npos)
+                throw error{fmt::format("line {}: expected `key,value`", line_number)};
+            const auto field = trim(rest.substr(0, comma));
+            key_text = field;
+            if (auto number = parse_unsigned(field))
+                key = *number;
+            else
+                key = std::string{field};
+            rest.remove_prefix(comma + 1);
+        }
+
+        const auto value = parse_unsigned(trim(rest));
+        if (!value) {
+            // Only the first row, after any comments, may be a header
+            if (header_allowed)
+                continue;
+            throw error{fmt::format(
+                "line {}: value must be an unsigned integer", line_number
+            )};
+        }
+        result.push_back({std::move(key), *value, std::move(key_text)});
+    }
+    return result;
+}
+
+class json_parser {
+public:
+    explicit json_parser(std::string_view text) : text_{text} {}
+
+    std::vector<raw_entry>
+    parse()
+    {
+        std::vector<raw_entry> result;
+        skip_whitespace();
+        if (consume('{')) {
+            if (!consume('}')) {
+                do {
+                    auto key = parse_string();
+                    expect(':');
+                    result.push_back({key, parse_number(), key});
+                } while (consume(','));
+                expect('}');
+            }
+        }
+        else if (consume('[')) {
+            if (!consume(']')) {
+                do {
+                    expect('[');
+                    raw_key key;
+                    std::string key_text;
+                    if (peek() == '"') {
+                        key_text = parse_string();
+                        key = key_text;
+                    }
+                    else {
+                        key_text = number_text();
+                        key = parse_number(key_text);
+                    }
+                    expect(',');
+                    result.push_back(
+                        {std::move(key), parse_number(), std::move(key_text)}
+                    );
+                    expect(']');
+                } while (consume(','));
+                expect(']');
+            }
+        }
+        else {
+            fail("expected an object or an array");
+        }
+        if (pos_ != text_.size())
+            fail("trailing characters");
+        return result;
+    }
+
+private:
+    [[noreturn]] void
+    fail(std::string_view what) const
+    {
+        throw error{fmt::format("json offset {}: {}", pos_, what)};
+    }
+
+    void
+    skip_whitespace()
+    {
+        while (pos_ < text_.size()
+               && (text_[pos_] == ' ' || text_[pos_] == '\t' || text_[pos_] == '\n'
+                   || text_[pos_] == '\r'))
+            ++pos_;
+    }
+
+    char
+    peek()
+    {
+        skip_whitespace();
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool
+    consume(char expected)
+    {
+        if (peek() != expected)
+            return false;
+        ++pos_;
+        skip_whitespace();
+        return true;
+    }
+
+    void
+    expect(char expected)
+    {
+        if (!consume(expected))
+            fail(fmt::format("expected '{}'", expected));
+    }
+
+    std::string
+    number_text()
+    {
+        skip_whitespace();
+        const auto start = pos_;
+        while (pos_ < text_.size() && text_[pos_] >= '0' && text_[pos_] <= '9')
+            ++pos_;
+        const auto text = text_.substr(start, pos_ - start);
+        skip_whitespace();
+        return std::string{text};
+    }
+
+    u64
+    parse_number(std::string_view text)
+    {
+        auto value = parse_unsigned(text);
+        if (!value)
+            fail("expected an unsigned integer");
+        return *value;
+    }
+
+    u64
+    parse_number()
+    {
+        return parse_number(number_text());
+    }
+
+    std::string
+    parse_string()
+    {
+        if (peek() != '"')
+            fail("expected a string");
+        ++pos_;
+        std::string result;
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            char ch = text_[pos_++];
+            if (ch != '\\') {
+                result += ch;
+                continue;
+            }
+            if (pos_ >= text_.size())
+                break;
+            switch (ch = text_[pos_++]) {
+                case 'n':
+                    result += '\n';
+                    break;
+                case 't':
+                    result += '\t';
+                    break;
+                case 'r':
+                    result += '\r';
+                    break;
+                case 'b':
+                    result += '\b';
+                    break;
+                case 'f':
+                    result += '\f';
+                    break;
+                case 'u':
+                    {
+                        if (text_.size() - pos_ < 4)
+                            fail("bad \\u escape");
+                        u32 code{};
+                        const auto* first = text_.data() + pos_;
+                        auto [ptr, ec] = std::from_chars(first, first + 4, code, 16);
+                        if (ec != std::errc{} || ptr != first + 4)
+                            fail("bad \\u escape");
+                        pos_ += 4;
+                        append_utf8(result, code);
+                        break;
+                    }
+                default:
+                    result += ch;
+            }
+        }
+        if (pos_ >= text_.size())
+            fail("unterminated string");
+        ++pos_;
+        skip_whitespace();
+        return result;
+    }
+
+    static void
+    append_utf8(std::string& out, u32 code)
+    {
+        if (code < 0x80) {
+            out += static_cast<char>(code);
+        }
+        else if (code < 0x800) {
+            out += static_cast<char>(0xC0 | (code >> 6));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+        else {
+            out += static_cast<char>(0xE0 | (code >> 12));
+            out += static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (code & 0x3F));
+        }
+    }
+
+    std::string_view text_;
+    std::size_t pos_{};
+};
+
+// ---- Key packing ----
+
+// Mirrors gloss::entries: strings pack little-endian into the narrowest word that
+// holds the longest key, integers keep a 32 or 64 bit word.
+struct key_set {
+    bool strings{};
+    u32 key_bytes{};
+    std::vector<u128> keys;
+    std::vector<u64> values;
+    std::vector<std::string> labels;
+};
+
+u32
+word_bytes(std::size_t max_size)
+{
+    for (u32 bytes : {1u, 2u, 4u, 8u, 16u}) {
+        if (max_size <= bytes)
+            return bytes;
+    }
+    throw error{fmt::format(
+        "keys of {} bytes do not fit in the widest key word (16 bytes)", max_size
+    )};
+}
+
+key_set
+pack_keys(std::vector<raw_entry> entries, KeyKind kind)
+{
+    if (entries.empty())
+        throw error{"input contains no entries"};
+
+    const bool all_integers = std::ranges::all_of(entries, [](const auto& entry) {
+        return std::holds_alternative<u64>(entry.key);
+    });
+    if (kind == KeyKind::integer && !all_integers)
+        throw error{"--key-type int given but some keys are not integers"};
+
+    key_set set;
+    set.strings = kind == KeyKind::string || !all_integers;
+
+    if (set.strings) {
+        std::size_t max_size{};
+        for (auto& entry : entries) {
+            if (std::holds_alternative<u64>(entry.key))
+                entry.key = entry.text;
+            max_size = std::max(max_size, std::get<std::string>(entry.key).size());
+        }
+        set.key_bytes = word_bytes(max_size);
+    }
+    else {
+        const auto max = std::ranges::max(entries, {}, [](const auto& entry) {
+                             return std::get<u64>(entry.key);
+                         }).key;
+        set.key_bytes = std::get<u64>(max) <= std::numeric_limits<u32>::max() ? 4 : 8;
+    }
+
+    for (const auto& entry : entries) {
+        if (const auto* text = std::get_if<std::string>(&entry.key)) {
+            set.keys.push_back(gloss::to<u128>(std::string_view{*text}));
+            set.labels.push_back(fmt::format("\"{}\"", *text));
+        }
+        else {
+            set.keys.push_back(std::get<u64>(entry.key));
+            set.labels.push_back(std::to_string(std::get<u64>(entry.key)));
+        }
+        set.values.push_back(entry.value);
+    }
+
+    std::vector<std::size_t> order(set.keys.size());
+    for (std::size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::ranges::sort(order, {}, [&](std::size_t i) { return set.keys[i]; });
+    for (std::size_t i = 1; i < order.size(); ++i) {
+        if (set.keys[order[i]] == set.keys[order[i - 1]]) {
+            throw error{fmt::format(
+                "duplicate key {} (also {})", set.labels[order[i]],
+                set.labels[order[i - 1]]
+            )};
+        }
+    }
+    return set;
+}
+
+// ---- Search ----
+
+struct pext_result {
+    u32 key_bytes{};
+    u128 mask{};
+    std::vector<u64> table;
+};
+
+std::optional<pext_result>
+search_pext(const key_set& set, u64 max_table_size)
+{
+    pext_result result;
+    result.mask = gloss::find_unique_mask(set.keys);
+    result.key_bytes = static_cast<u32>(gloss::pext_word_bytes(result.mask));
+
+    auto slot = [&](u128 key) -> u64 {
+        if (result.key_bytes <= 4)
+            return gloss::pext(static_cast<u32>(key), static_cast<u32>(result.mask));
+        if (result.key_bytes <= 8)
+            return gloss::pext(static_cast<u64>(key), static_cast<u64>(result.mask));
+        return static_cast<u64>(gloss::pext(key, result.mask));
+    };
+
+    u64 size{};
+    for (auto key : set.keys)
+        size = std::max(size, slot(key) + 1);
+    if (size > max_table_size)
+        return std::nullopt;
+
+    result.table.assign(size, 0);
+    for (std::size_t i = 0; i < set.keys.size(); ++i)
+        result.table[slot(set.keys[i])] = set.values[i];
+    return result;
+}
+
+struct displace_result {
+    u128 magic{};
+    u32 pilot_bytes{};
+    std::vector<u64> pilots;
+    std::vector<u64> table;
+};
+
+// Two level search: the table stays at about one slot per key however many keys there
+// are, where a single collision free magic needs a table that grows with the square.
+std::optional<displace_result>
+search_displace(const key_set& set, const options& opts)
+{
+    const bool wide = set.key_bytes > sizeof(u64);
+    const auto bucket_count = gloss::displace_bucket_count(set.keys.size());
+    const auto slot_count = gloss::displace_slot_count(set.keys.size());
+    if (slot_count > opts.max_table_size)
+        return std::nullopt;
+
+    auto place = [&](u128 magic, std::vector<u64>& pilots) {
+        if (wide)
+            return gloss::displace_keys(set.keys, magic, pilots, slot_count);
+        return gloss::displace_keys(
+            set.keys, static_cast<u64>(magic), pilots, slot_count
+        );
+    };
+
+    // Same candidates as gloss::find_displacement, which this splits across threads
+    auto magic = [&](u64 attempt) -> u128 {
+        if (wide)
+            return gloss::displace_magic<u128>(attempt);
+        return gloss::displace_magic<u64>(attempt);
+    };
+
+    std::atomic<u64> next{0};
+    std::atomic<u64> best{opts.attempts};
+
+    auto worker = [&]() {
+        std::vector<u64> pilots(bucket_count);
+        for (u64 attempt = next++; attempt < best.load(); attempt = next++) {
+            if (place(magic(attempt), pilots)) {
+                u64 current = best.load();
+                while (attempt < current
+                       && !best.compare_exchange_weak(current, attempt)) {}
+            }
+        }
+    };
+
+    std::vector<std::jthread> pool;
+    for (u32 i = 1; i < opts.threads; ++i)
+        pool.emplace_back(worker);
+    worker();
+    pool.clear();
+
+    if (best >= opts.attempts)
+        return std::nullopt;
+
+    displace_result result;
+    result.magic = magic(best);
+    result.pilots.resize(bucket_count);
+    place(result.magic, result.pilots);
+
+    const u64 max_pilot = std::ranges::max(result.pilots);
+    result.pilot_bytes = max_pilot <= std::numeric_limits<gloss::u8>::max() ? 1 : 2;
+
+    auto slot = [&](u128 key) {
+        if (wide)
+            return gloss::displace_lookup(key, result.magic, result.pilots, slot_count);
+        return gloss::displace_lookup(
+            key, static_cast<u64>(result.magic), result.pilots, slot_count
+        );
+    };
+
+    result.table.assign(slot_count, 0);
+    for (std::size_t i = 0; i < set.keys.size(); ++i)
+        result.table[slot(set.keys[i])] = set.values[i];
+    return result;
+}
+
+// ---- Emission ----
+
+std::string
+word_type(u32 bytes)
+{
+    return fmt::format("gloss::u{}", bytes * __CHAR_BIT__);
+}
+
+std::string
+literal(u128 value, u32 bytes)
+{
+    const auto low = static_cast<u64>(value);
+    const auto high = static_cast<u64>(value >> 64u);
+    if (bytes <= sizeof(u64))
+        return fmt::format("{:#x}u", low);
+    return fmt::format(
+        "(static_cast<gloss::u128>({:#x}u) << 64u | {:#x}u)", high, low
+    );
+}
+
+void
+emit_table(std::string& out, const std::vector<u64>& table)
+{
+    constexpr std::size_t PER_LINE = 16;
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        out += i % PER_LINE == 0 ? "\n        " : " ";
+        // Unsuffixed decimals above INT64_MAX don't fit any signed type
+        out += fmt::format("{}u,", table[i]);
+    }
+    out += "\n    ";
+}
+
+std::string
+emit_header(
+    const options& opts, const key_set& set, const std::optional<pext_result>& pext,
+    const std::optional<displace_result>& displace
+)
+{
+    const u64 max_value = std::ranges::max(set.values);
+    const u32 mapped_bytes = max_value <= std::numeric_limits<gloss::u8>::max()    ? 1
+                             : max_value <= std::numeric_limits<gloss::u16>::max() ? 2
+                             : max_value <= std::numeric_limits<u32>::max()        ? 4
+                                                                                   : 8;
+    const auto mapped = word_type(mapped_bytes);
+    const auto result = opts.result_type.empty() ? mapped : opts.result_type;
+
+    // File name only, so the header is the same wherever the input is checked out
+    std::string out = fmt::format(
+        "// Generated by gloss-gen from {}. Do not edit.\n"
+        "// {} keys\n\n"
+        "#pragma once\n\n"
+        "#include \"gloss.hpp\"\n",
+        std::filesystem::path{opts.input}.filename().string(), set.keys.size()
+    );
+    for (const auto& include : opts.includes)
+        out += fmt::format("#include {}\n", include);
+    out += '\n';
+    if (!opts.name_space.empty())
+        out += fmt::format("namespace {} {{\n\n", opts.name_space);
+
+    // Extra template argument that aligns the slot array
+    const auto alignment =
+        opts.align == 0 ? std::string{} : fmt::format(", {}", opts.align);
+
+    auto emit_pext = [&]() {
+        out += fmt::format(
+            "inline constexpr gloss::precomputed_pext<{}, {}, {}, {}{}> "
+            "{}{{\n    {},\n    {{",
+            word_type(pext->key_bytes), mapped, result, pext->table.size(), alignment,
+            opts.name, literal(pext->mask, pext->key_bytes)
+        );
+        emit_table(out, pext->table);
+        out += "}\n};\n";
+    };
+    auto emit_displace = [&]() {
+        const bool wide = set.key_bytes > sizeof(u64);
+        out += fmt::format(
+            "inline constexpr gloss::precomputed_displace<{}, {}, {}, {}, {}, {}{}> "
+            "{}{{\n    {},\n    {{",
+            word_type(set.key_bytes), mapped, result, word_type(displace->pilot_bytes),
+            displace->pilots.size(), displace->table.size(), alignment, opts.name,
+            literal(displace->magic, wide ? sizeof(u128) : sizeof(u64))
+        );
+        emit_table(out, displace->pilots);
+        out += "},\n    {";
+        emit_table(out, displace->table);
+        out += "}\n};\n";
+    };
+
+    if (pext && displace) {
+        out += "#ifdef __BMI2__\n";
+        emit_pext();
+        out += "#else\n";
+        emit_displace();
+        out += "#endif\n";
+    }
+    else if (pext) {
+        emit_pext();
+    }
+    else {
+        emit_displace();
+    }
+
+    if (!opts.name_space.empty())
+        out += fmt::format("\n}} // namespace {}\n", opts.name_space);
+    return out;
+}
+
+// ---- Driver ----
+
+constexpr std::string_view USAGE =
+    "usage: gloss-gen --input FILE --output FILE --name NAME [options]\n"
+    "\n"
+    "  --namespace NS         namespace for the emitted table\n"
+    "  --format csv|json      input format (default: from the file extension)\n"
+    "  --key-type auto|int|string\n"
+    "  --method any|pext|array\n"
+    "                         pext takes one access but its table can grow far past\n"
+    "                         the key count; array is a two level displacement table\n"
+    "                         of about one slot per key. any emits pext under\n"
+    "                         __BMI2__ when its table is compact, and the array\n"
+    "                         otherwise (default: any)\n"
+    "  --result-type TYPE     type lookup returns, e.g. an enum\n"
+    "                         (default: mapped type)\n"
+    "  --include HEADER       extra #include for --result-type,\n"
+    "                         e.g. '<foo/ticker.hpp>'\n"
+    "  --threads N            search threads (default: hardware concurrency)\n"
+    "  --attempts N           magics tried before giving up (default: 10000)\n"
+    "  --max-table-size N     largest table to emit, in slots (default: 1048576)\n"
+    "  --align BYTES          align the slot array, e.g. 64 to start it on a\n"
+    "                         cache line\n";
+
+options
+parse_args(int argc, char** argv)
+{
+    options opts;
+    const std::vector<std::string_view> args(argv + 1, argv + argc);
+
+    for (std::size_t i = 0; i < args.size(); ++i) {
+        const auto flag = args[i];
+        if (flag == "--help" || flag == "-h") {
+            fmt::print("{}", USAGE);
+            std::exit(0);
+        }
+        if (i + 1 >= args.size())
+            throw error{fmt::format("missing value for {}", flag)};
+        const std::string value{args[++i]};
+
+        auto number = [&]() {
+            auto parsed = parse_unsigned(value);
+            if (!parsed || *parsed == 0)
+                throw error{fmt::format("{} expects a positive integer", flag)};
+            return *parsed;
+        };
+
+        if (flag == "--input")
+            opts.input = value;
+        else if (flag == "--output")
+            opts.output = value;
+        else if (flag == "--name")
+            opts.name = value;
+        else if (flag == "--namespace")
+            opts.name_space = value;
+        else if (flag == "--format")
+            opts.format = value;
+        else if (flag == "--result-type")
+            opts.result_type = value;
+        else if (flag == "--include")
+            opts.includes.push_back(value);
+        else if (flag == "--threads")
+            opts.threads = static_cast<u32>(number());
+        else if (flag == "--attempts")
+            opts.attempts = static_cast<u32>(number());
+        else if (flag == "--max-table-size")
+            opts.max_table_size = number();
+        else if (flag == "--align") {
+            opts.align = number();
+            if (!std::has_single_bit(opts.align))
+                throw error{"--align expects a power of two"};
+        }
+        else if (flag == "--key-type") {
+            if (value == "auto")
+                opts.key_kind = KeyKind::automatic;
+            else if (value == "int")
+                opts.key_kind = KeyKind::integer;
+            else if (value == "string")
+                opts.key_kind = KeyKind::string;
+            else
+                throw error{fmt::format("unknown key type '{}'", value)};
+        }
+        else if (flag == "--method") {
+            if (value == "any")
+                opts.method = Method::any;
+            else if (value == "pext")
+                opts.method = Method::pext;
+            else if (value == "array")
+                opts.method = Method::array;
+            else
+                throw error{fmt::format("unknown method '{}'", value)};
+        }
+        else
+            throw error{fmt::format("unknown option '{}'", flag)};
+    }
+
+    if (opts.input.empty() || opts.output.empty() || opts.name.empty())
+        throw error{"--input, --output and --name are required"};
+    if (opts.format.empty())
+        opts.format = opts.input.ends_with(".json") ? "json" : "csv";
+    if (opts.format != "csv" && opts.format != "json")
+        throw error{fmt::format("unknown format '{}'", opts.format)};
+    return opts;
+}
+
+std::string
+read_file(const std::string& path)
+{
+    std::ifstream file{path, std::ios::binary};
+    if (!file)
+        throw error{fmt::format("cannot open {}", path)};
+    std::ostringstream contents;
+    contents << file.rdbuf();
+    return std::move(contents).str();
+}
+
+void
+write_file(const std::string& path, const std::string& contents)
+{
+    std::ofstream file{path, std::ios::binary | std::ios::trunc};
+    if (!file || !(file << contents))
+        throw error{fmt::format("cannot write {}", path)};
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+    try {
+        const auto opts = parse_args(argc, argv);
+        const auto contents = read_file(opts.input);
+        auto entries =
+            opts.format == "json" ? json_parser{contents}.parse() : parse_csv(contents);
+        const auto set = pack_keys(std::move(entries), opts.key_kind);
+
+        std::optional<pext_result> pext;
+        std::optional<displace_result> displace;
+        if (opts.method != Method::array)
+            pext = search_pext(set, opts.max_table_size);
+        if (opts.method != Method::pext)
+            displace = search_displace(set, opts);
+
+        // A sparse pext table costs more cache than the second access it saves
+        if (opts.method == Method::any && pext && displace
+            && pext->table.size() > 2 * set.keys.size())
+            pext.reset();
+
+        if (!pext && !displace) {
+            throw error{fmt::format(
+                "no perfect hash for {} keys within {} slots; raise "
+                "--max-table-size or --attempts",
+                set.keys.size(), opts.max_table_size
+            )};
+        }
+        write_file(opts.output, emit_header(opts, set, pext, displace));
+    } catch (const std::exception& e) {
+        fmt::print(stderr, "gloss-gen: {}\n", e.what());
+        return 1;
+    }
+    return 0;
+}